@@ -0,0 +1,165 @@
+// display_port.h on an in-memory framebuffer, for the host build: LVGL
+// renders into heap_caps draw buffers sized like the device's and its flush
+// copies them into the framebuffer. There is no LVGL task; the caller
+// refreshes with display_manager_refresh_now().
+#include "display_port_fb.h"
+#include "config.h"
+#include "display_port.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "display_port_fb";
+
+static uint16_t framebuffer[AMOLED_WIDTH * AMOLED_HEIGHT];
+static lv_display_t *disp_handle = NULL;
+static void *draw_buffers[2];
+static bool lvgl_started = false;
+static bool panel_started = false;
+static pthread_mutex_t lvgl_lock;
+
+// Flush start to flush ready, summed until display_port_take_flush_us
+static uint32_t flush_time_us;
+
+static uint32_t tick_ms(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void copy_to_framebuffer(int x, int y, int w, int h,
+                                const uint16_t *pixels, bool swap) {
+  for (int row = 0; row < h; row++) {
+    uint16_t *dst = framebuffer + (y + row) * AMOLED_WIDTH + x;
+    const uint16_t *src = pixels + row * w;
+    for (int col = 0; col < w; col++) {
+      dst[col] = swap ? (uint16_t)((src[col] >> 8) | (src[col] << 8))
+                      : src[col];
+    }
+  }
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area,
+                     uint8_t *px_map) {
+  int64_t start_us = esp_timer_get_time();
+  copy_to_framebuffer(area->x1, area->y1, lv_area_get_width(area),
+                      lv_area_get_height(area), (const uint16_t *)px_map,
+                      false);
+  flush_time_us += (uint32_t)(esp_timer_get_time() - start_us);
+  lv_display_flush_ready(disp);
+}
+
+static void start_lvgl(void) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&lvgl_lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  lv_init();
+  lv_tick_set_cb(tick_ms);
+  lvgl_started = true;
+}
+
+esp_err_t display_port_init(const display_profile_t *profile) {
+  ESP_LOGI(TAG, "Initialize framebuffer (%s): %s refresh, %s buffer, %u lines",
+           profile->name, profile->full_refresh ? "full" : "partial",
+           profile->double_buffer ? "double" : "single",
+           profile->buffer_lines);
+
+  if (!lvgl_started) {
+    start_lvgl();
+  }
+
+  // Same buffer sizes as the device; pclk does not apply
+  uint32_t lines =
+      profile->full_refresh ? AMOLED_HEIGHT : profile->buffer_lines;
+  size_t size = (size_t)AMOLED_WIDTH * lines * sizeof(uint16_t);
+  draw_buffers[0] = heap_caps_malloc(size, MALLOC_CAP_DMA);
+  draw_buffers[1] =
+      profile->double_buffer ? heap_caps_malloc(size, MALLOC_CAP_DMA) : NULL;
+  if (!draw_buffers[0] || (profile->double_buffer && !draw_buffers[1])) {
+    ESP_LOGE(TAG, "No memory for %lu-line draw buffers",
+             (unsigned long)lines);
+    display_port_deinit();
+    return ESP_ERR_NO_MEM;
+  }
+
+  display_port_lock();
+  disp_handle = lv_display_create(AMOLED_WIDTH, AMOLED_HEIGHT);
+  lv_display_set_color_format(disp_handle, LV_COLOR_FORMAT_RGB565);
+  lv_display_set_buffers(disp_handle, draw_buffers[0], draw_buffers[1],
+                         (uint32_t)size,
+                         profile->full_refresh
+                             ? LV_DISPLAY_RENDER_MODE_FULL
+                             : LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_set_flush_cb(disp_handle, flush_cb);
+  display_port_unlock();
+  return ESP_OK;
+}
+
+void display_port_deinit(void) {
+  if (disp_handle) {
+    display_port_lock();
+    lv_display_delete(disp_handle);
+    display_port_unlock();
+    disp_handle = NULL;
+  }
+  for (int i = 0; i < 2; i++) {
+    heap_caps_free(draw_buffers[i]);
+    draw_buffers[i] = NULL;
+  }
+}
+
+void display_port_wake(void) {}
+
+uint32_t display_port_take_flush_us(void) {
+  uint32_t us = flush_time_us;
+  flush_time_us = 0;
+  return us;
+}
+
+bool display_port_lock(void) {
+  return lvgl_started && pthread_mutex_lock(&lvgl_lock) == 0;
+}
+
+void display_port_unlock(void) { pthread_mutex_unlock(&lvgl_lock); }
+
+esp_err_t display_port_panel_init(uint8_t pclk_mhz) {
+  panel_started = true;
+  return ESP_OK;
+}
+
+esp_err_t display_port_draw(int x, int y, int w, int h,
+                            const uint16_t *pixels) {
+  if (!panel_started) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  // Stored in memory order, like LVGL's flushes
+  copy_to_framebuffer(x, y, w, h, pixels, true);
+  return ESP_OK;
+}
+
+const uint16_t *display_port_fb_pixels(void) { return framebuffer; }
+
+esp_err_t display_port_fb_write_ppm(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    ESP_LOGE(TAG, "Cannot write %s", path);
+    return ESP_FAIL;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", AMOLED_WIDTH, AMOLED_HEIGHT);
+  for (size_t i = 0; i < sizeof(framebuffer) / sizeof(framebuffer[0]); i++) {
+    uint16_t c = framebuffer[i];
+    // Widen each channel, repeating its top bits into the new low ones
+    uint8_t rgb[3] = {
+        (uint8_t)(((c >> 11) << 3) | (c >> 13)),
+        (uint8_t)((((c >> 5) & 0x3F) << 2) | ((c >> 9) & 0x03)),
+        (uint8_t)(((c & 0x1F) << 3) | ((c >> 2) & 0x07)),
+    };
+    fwrite(rgb, 1, sizeof(rgb), f);
+  }
+  return fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+}
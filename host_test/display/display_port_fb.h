@@ -0,0 +1,17 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+// Host-only calls of the framebuffer display_port: the panel is an RGB565
+// array in memory, in LVGL's byte order, that flushes copy into
+
+/**
+ * @brief The framebuffer, AMOLED_WIDTH * AMOLED_HEIGHT pixels, row by row
+ */
+const uint16_t *display_port_fb_pixels(void);
+
+/**
+ * @brief Write the framebuffer as a binary PPM (P6) image
+ */
+esp_err_t display_port_fb_write_ppm(const char *path);
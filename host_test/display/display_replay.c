@@ -0,0 +1,186 @@
+// Host replay of a status sequence through display_manager.c on an LVGL
+// memory framebuffer. Each step is drawn as one frame; its render time,
+// invalidated area and flushed pixels are logged and it is written as
+// frame_NN.ppm. The same sequence is then timed with every benchmark profile.
+//   display_replay [frame dir]
+#include "config.h"
+#include "deploy_state.h"
+#include "display_bench.h"
+#include "display_manager.h"
+#include "display_port_fb.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *const names[] = {"production", "staging", "preview"};
+#define ROWS ((int)(sizeof(names) / sizeof(names[0])))
+#define SCREEN_PX (AMOLED_WIDTH * AMOLED_HEIGHT)
+
+// One frame's changes: a row's state and note, and the bottom strip
+typedef struct {
+  const char *what;
+  int row;            // -1 for none
+  int state;          // deploy_state_t, -1 to leave it
+  const char *note;   // NULL to leave it
+  const char *bottom; // NULL to leave it
+} replay_step_t;
+
+// Boot with saved states, a poll cycle, then a deployment going out
+static const replay_step_t steps[] = {
+    {"saved states", -1, -1, NULL, "connecting wifi..."},
+    {"time synced", -1, -1, NULL, "checking status..."},
+    {"production refreshing", 0, -1, "refreshing", NULL},
+    {"production live", 0, DEPLOY_STATE_SUCCESS, "", NULL},
+    {"staging refreshing", 1, -1, "refreshing", NULL},
+    {"staging live", 1, DEPLOY_STATE_IN_PROGRESS, "", NULL},
+    {"preview refreshing", 2, -1, "refreshing", NULL},
+    {"preview live", 2, DEPLOY_STATE_FAILURE, "", NULL},
+    {"cycle done", -1, -1, NULL, "checked: 12:00:00"},
+    {"staging refreshing", 1, -1, "refreshing", NULL},
+    {"staging unchanged", 1, DEPLOY_STATE_IN_PROGRESS, "", NULL},
+    {"clock", -1, -1, NULL, "checked: 12:00:10"},
+    {"staging deployed", 1, DEPLOY_STATE_SUCCESS, NULL, NULL},
+    {"clock", -1, -1, NULL, "checked: 12:00:20"},
+};
+#define STEPS ((int)(sizeof(steps) / sizeof(steps[0])))
+
+typedef struct {
+  uint32_t frame_us; // display_manager_refresh_now wall time
+  uint32_t render_us;
+  uint32_t areas;
+  uint64_t invalidated_px;
+  uint64_t flushed_px;
+} frame_cost_t;
+
+static void show_saved_states(void) {
+  static const deploy_state_t saved[ROWS] = {
+      DEPLOY_STATE_SUCCESS, DEPLOY_STATE_SUCCESS, DEPLOY_STATE_FAILURE};
+  display_manager_clear();
+  display_manager_set_bg_color(0, 0, 0);
+  display_manager_dashboard_create(names, ROWS, TEXT_SIZE_22);
+  for (int i = 0; i < ROWS; i++) {
+    display_manager_dashboard_set_state(i, saved[i]);
+    display_manager_dashboard_set_note(i, "stale Oct 16 09:41");
+  }
+}
+
+static void apply_step(const replay_step_t *step) {
+  if (step->row >= 0 && step->state >= 0) {
+    display_manager_dashboard_set_state(step->row,
+                                        (deploy_state_t)step->state);
+  }
+  if (step->row >= 0 && step->note) {
+    display_manager_dashboard_set_note(step->row, step->note);
+  }
+  if (step->bottom) {
+    display_manager_dashboard_set_bottom(step->bottom);
+  }
+}
+
+static void draw_frame(frame_cost_t *cost) {
+  display_stats_t before;
+  display_stats_t after;
+  display_manager_get_stats(&before);
+  int64_t start_us = esp_timer_get_time();
+  display_manager_refresh_now(false);
+  cost->frame_us = (uint32_t)(esp_timer_get_time() - start_us);
+  display_manager_get_stats(&after);
+
+  cost->render_us = (uint32_t)(after.render_us - before.render_us);
+  cost->areas = after.invalidated_areas - before.invalidated_areas;
+  cost->invalidated_px = after.invalidated_px - before.invalidated_px;
+  cost->flushed_px = after.flushed_px - before.flushed_px;
+}
+
+// The sequence with the menuconfig profile, one line and one PPM per frame
+static int replay_frames(const char *dir) {
+  mkdir(dir, 0755);
+  printf("%-2s %-22s %8s %8s %5s %9s %6s %9s\n", "#", "step", "frame us",
+         "render", "areas", "inval px", "screen", "flush px");
+
+  int failures = 0;
+  for (int i = 0; i <= STEPS; i++) {
+    const char *what = i == 0 ? "boot" : steps[i - 1].what;
+    if (i == 0) {
+      show_saved_states();
+    } else {
+      apply_step(&steps[i - 1]);
+    }
+
+    frame_cost_t cost;
+    draw_frame(&cost);
+    printf("%-2d %-22s %8lu %8lu %5lu %9llu %5.1f%% %9llu\n", i, what,
+           (unsigned long)cost.frame_us, (unsigned long)cost.render_us,
+           (unsigned long)cost.areas, (unsigned long long)cost.invalidated_px,
+           100.0 * (double)cost.invalidated_px / SCREEN_PX,
+           (unsigned long long)cost.flushed_px);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%02d.ppm", dir, i);
+    if (display_port_fb_write_ppm(path) != ESP_OK) {
+      failures++;
+    }
+    // After the first frame only what a step changed should be redrawn
+    if (i > 0 && cost.flushed_px >= SCREEN_PX) {
+      fprintf(stderr, "FAIL step %d (%s) redrew the whole screen\n", i, what);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+// The sequence's total cost with each benchmark profile
+static void replay_profiles(void) {
+#define X(name_, full_, double_, lines_, pclk_)                                \
+  {.name = #name_,                                                             \
+   .full_refresh = full_,                                                      \
+   .double_buffer = double_,                                                   \
+   .buffer_lines = lines_,                                                     \
+   .pclk_mhz = pclk_},
+  static const display_profile_t profiles[] = {DISPLAY_BENCH_PROFILES};
+#undef X
+
+  printf("\n%-18s %8s %10s %10s %12s\n", "profile", "RAM", "frame us",
+         "render us", "flush px");
+  for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+    size_t ram_bytes = 0;
+    if (display_manager_set_profile(&profiles[p], &ram_bytes) != ESP_OK) {
+      printf("%-18s does not fit\n", profiles[p].name);
+      continue;
+    }
+
+    frame_cost_t total = {0};
+    for (int i = 0; i <= STEPS; i++) {
+      if (i == 0) {
+        show_saved_states();
+      } else {
+        apply_step(&steps[i - 1]);
+      }
+      frame_cost_t cost;
+      draw_frame(&cost);
+      total.frame_us += cost.frame_us;
+      total.render_us += cost.render_us;
+      total.flushed_px += cost.flushed_px;
+    }
+    printf("%-18s %8u %10lu %10lu %12llu\n", profiles[p].name,
+           (unsigned)ram_bytes, (unsigned long)total.frame_us,
+           (unsigned long)total.render_us,
+           (unsigned long long)total.flushed_px);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *dir = argc > 1 ? argv[1] : "frames";
+  if (display_manager_init() != ESP_OK) {
+    fprintf(stderr, "display_manager_init failed\n");
+    return 1;
+  }
+
+  int failures = replay_frames(dir);
+  replay_profiles();
+  printf("\n%d frames written to %s, %d failures\n", STEPS + 1, dir,
+         failures);
+  return failures ? 1 : 0;
+}
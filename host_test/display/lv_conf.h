@@ -0,0 +1,19 @@
+// LVGL configuration for the host display build: what the firmware's
+// sdkconfig gives LVGL, everything else at LVGL's defaults
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+#define LV_MEM_SIZE (64 * 1024U)
+#define LV_USE_LOG 0
+
+// sdkconfig.defaults fonts, plus the Kconfig default 14
+#define LV_FONT_MONTSERRAT_10 1
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_22 1
+#define LV_FONT_MONTSERRAT_28 1
+#define LV_FONT_MONTSERRAT_34 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+
+#endif // LV_CONF_H
@@ -0,0 +1,8 @@
+#pragma once
+// Forced into every source: what ESP-IDF's newlib has and glibc may not
+#include <stddef.h>
+
+#ifdef SHIM_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// One pool the size of the ESP32's internal RAM, so heap_caps_get_free_size
+// shows what a display profile takes
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define SHIM_HEAP_SIZE (320 * 1024)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
@@ -0,0 +1,20 @@
+#pragma once
+#include "esp_err.h"
+#include <stdint.h>
+
+// Periodic timers run their callback on a thread of their own
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  const char *name;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *out);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
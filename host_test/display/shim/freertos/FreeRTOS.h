@@ -0,0 +1,24 @@
+#pragma once
+#include <pthread.h>
+#include <stdint.h>
+
+// Enough FreeRTOS for display_manager.c, on pthreads, with 1 ms ticks
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// Critical sections become a mutex per portMUX
+typedef pthread_mutex_t portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED PTHREAD_MUTEX_INITIALIZER
+#define taskENTER_CRITICAL(mux) pthread_mutex_lock(mux)
+#define taskEXIT_CRITICAL(mux) pthread_mutex_unlock(mux)
+#define taskENTER_CRITICAL_ISR(mux) pthread_mutex_lock(mux)
+#define taskEXIT_CRITICAL_ISR(mux) pthread_mutex_unlock(mux)
@@ -0,0 +1,16 @@
+#pragma once
+// menuconfig defaults for the LVGL display path, with statistics on and the
+// periodic log off
+#define CONFIG_BOTTOM_TEXT_HEIGHT 30
+#define CONFIG_DISPLAY_DASHBOARD_PAGE_SECONDS 5
+#define CONFIG_DISPLAY_DOUBLE_BUFFER 1
+#define CONFIG_DISPLAY_BUFFER_LINES 100
+#define CONFIG_DISPLAY_SPI_CLOCK_MHZ 27
+#define CONFIG_DISPLAY_STATS 1
+#define CONFIG_DISPLAY_STATS_LOG_INTERVAL 0
+#define CONFIG_LV_FONT_MONTSERRAT_10 1
+#define CONFIG_LV_FONT_MONTSERRAT_14 1
+#define CONFIG_LV_FONT_MONTSERRAT_16 1
+#define CONFIG_LV_FONT_MONTSERRAT_22 1
+#define CONFIG_LV_FONT_MONTSERRAT_28 1
+#define CONFIG_LV_FONT_MONTSERRAT_34 1
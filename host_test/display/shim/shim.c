@@ -0,0 +1,335 @@
+// ESP-IDF and FreeRTOS calls used by the display path, on pthreads
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const char *esp_err_to_name(esp_err_t code) {
+  switch (code) {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_NOT_SUPPORTED:
+    return "ESP_ERR_NOT_SUPPORTED";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  default:
+    return "UNKNOWN ERROR";
+  }
+}
+
+#ifdef SHIM_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size) {
+  size_t len = strnlen(dst, size);
+  return len == size ? size + strlen(src)
+                     : len + strlcpy(dst + len, src, size - len);
+}
+#endif
+
+int64_t esp_timer_get_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Deadline us from now, for pthread_cond_timedwait
+static struct timespec deadline_after_us(uint64_t us) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec += (time_t)(us / 1000000);
+  ts.tv_nsec += (long)(us % 1000000) * 1000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+  return ts;
+}
+
+// heap_caps: a size header in front of each block, counted against the pool
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t heap_used = 0;
+
+typedef struct {
+  size_t size;
+  max_align_t align;
+} heap_header_t;
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+  heap_header_t *block = malloc(sizeof(heap_header_t) + size);
+  if (!block) {
+    return NULL;
+  }
+  pthread_mutex_lock(&heap_lock);
+  bool fits = heap_used + size <= SHIM_HEAP_SIZE;
+  if (fits) {
+    heap_used += size;
+  }
+  pthread_mutex_unlock(&heap_lock);
+  if (!fits) {
+    free(block);
+    return NULL;
+  }
+  block->size = size;
+  return block + 1;
+}
+
+void heap_caps_free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  heap_header_t *block = (heap_header_t *)ptr - 1;
+  pthread_mutex_lock(&heap_lock);
+  heap_used -= block->size;
+  pthread_mutex_unlock(&heap_lock);
+  free(block);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  pthread_mutex_lock(&heap_lock);
+  size_t free_size = SHIM_HEAP_SIZE - heap_used;
+  pthread_mutex_unlock(&heap_lock);
+  return free_size;
+}
+
+// Tasks: never deleted, so their handles stay valid
+
+struct task {
+  TaskFunction_t fn;
+  void *arg;
+  pthread_mutex_t lock;
+  pthread_cond_t notified;
+  uint32_t notifications;
+};
+
+static _Thread_local TaskHandle_t current_task = NULL;
+
+static void *task_main(void *p) {
+  current_task = p;
+  current_task->fn(current_task->arg);
+  return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out) {
+  TaskHandle_t task = calloc(1, sizeof(*task));
+  if (!task) {
+    return pdFAIL;
+  }
+  task->fn = fn;
+  task->arg = arg;
+  pthread_mutex_init(&task->lock, NULL);
+  pthread_cond_init(&task->notified, NULL);
+  // Before the thread runs, like FreeRTOS
+  if (out) {
+    *out = task;
+  }
+
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, task_main, task) != 0) {
+    if (out) {
+      *out = NULL;
+    }
+    free(task);
+    return pdFAIL;
+  }
+  pthread_detach(thread);
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  pthread_mutex_lock(&task->lock);
+  task->notifications++;
+  pthread_cond_signal(&task->notified);
+  pthread_mutex_unlock(&task->lock);
+  return pdPASS;
+}
+
+// Only called from tasks made by xTaskCreate
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  TaskHandle_t task = current_task;
+  struct timespec deadline =
+      deadline_after_us((uint64_t)wait * portTICK_PERIOD_MS * 1000);
+  pthread_mutex_lock(&task->lock);
+  while (!task->notifications && wait) {
+    if (wait == portMAX_DELAY) {
+      pthread_cond_wait(&task->notified, &task->lock);
+    } else if (pthread_cond_timedwait(&task->notified, &task->lock,
+                                      &deadline) == ETIMEDOUT) {
+      break;
+    }
+  }
+  uint32_t count = task->notifications;
+  if (count) {
+    task->notifications = clear ? 0 : count - 1;
+  }
+  pthread_mutex_unlock(&task->lock);
+  return count;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  uint64_t us = (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+  struct timespec ts = {.tv_sec = (time_t)(us / 1000000),
+                        .tv_nsec = (long)(us % 1000000) * 1000};
+  nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+// Binary semaphores: a flag under a mutex
+
+struct semaphore {
+  pthread_mutex_t lock;
+  pthread_cond_t given;
+  bool available;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+  if (sem) {
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->given, NULL);
+  }
+  return sem;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  pthread_mutex_lock(&sem->lock);
+  BaseType_t given = sem->available ? pdFALSE : pdTRUE;
+  sem->available = true;
+  pthread_cond_signal(&sem->given);
+  pthread_mutex_unlock(&sem->lock);
+  return given;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait) {
+  struct timespec deadline =
+      deadline_after_us((uint64_t)wait * portTICK_PERIOD_MS * 1000);
+  pthread_mutex_lock(&sem->lock);
+  while (!sem->available && wait) {
+    if (wait == portMAX_DELAY) {
+      pthread_cond_wait(&sem->given, &sem->lock);
+    } else if (pthread_cond_timedwait(&sem->given, &sem->lock, &deadline) ==
+               ETIMEDOUT) {
+      break;
+    }
+  }
+  BaseType_t taken = sem->available ? pdTRUE : pdFALSE;
+  sem->available = false;
+  pthread_mutex_unlock(&sem->lock);
+  return taken;
+}
+
+// Timers: each start runs a thread until the next stop or start
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  bool running;
+  uint64_t period_us;
+  unsigned generation; // bumped by start and stop, ends older threads
+};
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *out) {
+  esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+  if (!timer) {
+    return ESP_ERR_NO_MEM;
+  }
+  timer->callback = args->callback;
+  timer->arg = args->arg;
+  pthread_mutex_init(&timer->lock, NULL);
+  pthread_cond_init(&timer->changed, NULL);
+  *out = timer;
+  return ESP_OK;
+}
+
+typedef struct {
+  esp_timer_handle_t timer;
+  unsigned generation;
+} timer_start_t;
+
+static void *timer_main(void *p) {
+  timer_start_t start = *(timer_start_t *)p;
+  free(p);
+  esp_timer_handle_t timer = start.timer;
+  unsigned generation = start.generation;
+  pthread_mutex_lock(&timer->lock);
+  while (timer->generation == generation) {
+    struct timespec deadline = deadline_after_us(timer->period_us);
+    if (pthread_cond_timedwait(&timer->changed, &timer->lock, &deadline) ==
+            ETIMEDOUT &&
+        timer->generation == generation) {
+      pthread_mutex_unlock(&timer->lock);
+      timer->callback(timer->arg);
+      pthread_mutex_lock(&timer->lock);
+    }
+  }
+  pthread_mutex_unlock(&timer->lock);
+  return NULL;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period_us) {
+  pthread_mutex_lock(&timer->lock);
+  esp_err_t err = ESP_OK;
+  if (timer->running) {
+    err = ESP_ERR_INVALID_STATE;
+  } else {
+    timer_start_t *start = malloc(sizeof(*start));
+    pthread_t thread;
+    if (start) {
+      timer->running = true;
+      timer->period_us = period_us;
+      start->timer = timer;
+      start->generation = ++timer->generation;
+    }
+    if (start && pthread_create(&thread, NULL, timer_main, start) == 0) {
+      pthread_detach(thread);
+    } else {
+      free(start);
+      timer->running = false;
+      err = ESP_ERR_NO_MEM;
+    }
+  }
+  pthread_mutex_unlock(&timer->lock);
+  return err;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  pthread_mutex_lock(&timer->lock);
+  esp_err_t err = timer->running ? ESP_OK : ESP_ERR_INVALID_STATE;
+  timer->running = false;
+  timer->generation++;
+  pthread_cond_broadcast(&timer->changed);
+  pthread_mutex_unlock(&timer->lock);
+  return err;
+}
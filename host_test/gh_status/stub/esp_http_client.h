@@ -0,0 +1,38 @@
+#pragma once
+#include "esp_err.h"
+#include <string.h>
+
+#ifdef STUB_STRLCPY
+static inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+// The events and fields the firmware's handlers read
+typedef enum {
+  HTTP_EVENT_ERROR,
+  HTTP_EVENT_ON_CONNECTED,
+  HTTP_EVENT_HEADER_SENT,
+  HTTP_EVENT_ON_HEADER,
+  HTTP_EVENT_ON_DATA,
+  HTTP_EVENT_ON_FINISH,
+  HTTP_EVENT_DISCONNECTED,
+} esp_http_client_event_id_t;
+
+typedef struct esp_http_client_event {
+  esp_http_client_event_id_t event_id;
+  void *data;
+  int data_len;
+  void *user_data;
+  char *header_key;
+  char *header_value;
+} esp_http_client_event_t;
+
+typedef enum { HTTP_METHOD_GET, HTTP_METHOD_POST } esp_http_client_method_t;
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
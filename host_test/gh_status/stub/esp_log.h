@@ -0,0 +1,10 @@
+#pragma once
+#include <stdio.h>
+
+// Arguments are type-checked, not printed
+#define ESP_LOG_QUIET(tag, fmt, ...)                                           \
+  ((void)(tag), (void)sizeof(printf(fmt, ##__VA_ARGS__)))
+#define ESP_LOGE ESP_LOG_QUIET
+#define ESP_LOGW ESP_LOG_QUIET
+#define ESP_LOGI ESP_LOG_QUIET
+#define ESP_LOGD ESP_LOG_QUIET
@@ -0,0 +1,4 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
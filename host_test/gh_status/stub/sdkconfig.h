@@ -0,0 +1,7 @@
+#pragma once
+
+// REST mode, one repository
+#define CONFIG_GITHUB_USERNAME "octocat"
+#define CONFIG_GITHUB_REPO "Hello-World"
+#define CONFIG_GITHUB_AUTH_TOKEN "test"
+#define CONFIG_VERCEL_AUTH_TOKEN "test"
@@ -0,0 +1,99 @@
+// Host test for gh_status_manager.c's conditional requests: a fake GitHub
+// answers with real-length weak ETags and 304s, and the test checks that the
+// next request sends back the whole ETag and is answered from the cache, and
+// that an ETag too long to keep is not sent at all.
+#include "../../main/gh_status_manager.c"
+#include <stdio.h>
+
+#define DEPLOYMENT_ID "1874329921"
+
+// GitHub's weak SHA-256 form, 68 characters
+static const char github_etag[] =
+    "W/\"6f1ed002ab5595859014ebf0951522d9c0cd8b3d4d0b8d9c1b3e5f1a2b3c4d5e\"";
+
+static char server_etag[160]; // what the fake sends and matches against
+static char sent_if_none_match[160];
+static int requests = 0;
+static int not_modified = 0;
+static int failures = 0;
+
+// One request to the fake server: 304 when If-None-Match matches, else 200
+// with the body for the URL; the ETag header is sent either way
+esp_err_t http_conn_perform(http_host_t host,
+                            const http_conn_request_t *request,
+                            int *status_code) {
+  requests++;
+  snprintf(sent_if_none_match, sizeof(sent_if_none_match), "%s",
+           request->if_none_match ? request->if_none_match : "");
+
+  esp_http_client_event_t header = {
+      .event_id = HTTP_EVENT_ON_HEADER,
+      .user_data = request->user_data,
+      .header_key = "ETag",
+      .header_value = server_etag,
+  };
+  request->event_handler(&header);
+
+  if (request->if_none_match &&
+      strcmp(request->if_none_match, server_etag) == 0) {
+    not_modified++;
+    *status_code = 304;
+    return ESP_OK;
+  }
+  const char *body = strstr(request->url, "/statuses")
+                         ? "[{\"state\":\"success\",\"id\":7}]"
+                         : "[{\"id\":" DEPLOYMENT_ID ",\"creator\":{}}]";
+  json_scanner_feed(request->scanner, body, strlen(body));
+  *status_code = 200;
+  return ESP_OK;
+}
+
+static void expect(const char *test, const char *what, bool ok) {
+  if (!ok) {
+    fprintf(stderr, "FAIL %s: %s\n", test, what);
+    failures++;
+  }
+}
+
+static void check_target(const char *test, const char *target) {
+  deploy_state_t state = DEPLOY_STATE_UNKNOWN;
+  char deployment_id[DEPLOY_ID_LEN];
+  expect(test, "status",
+         gh_check_deployment_status(target, &state, deployment_id) == ESP_OK);
+  expect(test, "state", state == DEPLOY_STATE_SUCCESS);
+  expect(test, "deployment ID", strcmp(deployment_id, DEPLOYMENT_ID) == 0);
+}
+
+// The second poll sends the whole ETag back and costs one 304
+static void test_full_etag(void) {
+  snprintf(server_etag, sizeof(server_etag), "%s", github_etag);
+  check_target(__func__, "production");
+
+  requests = 0;
+  not_modified = 0;
+  check_target(__func__, "production");
+  expect(__func__, "If-None-Match is the whole ETag",
+         strcmp(sent_if_none_match, github_etag) == 0);
+  expect(__func__, "one request, answered 304",
+         requests == 1 && not_modified == 1);
+}
+
+// An ETag that does not fit is never sent cut short
+static void test_etag_too_long(void) {
+  memset(server_etag, 'a', MAX_ETAG_SIZE + 8);
+  server_etag[MAX_ETAG_SIZE + 8] = '\0';
+  check_target(__func__, "staging");
+
+  requests = 0;
+  not_modified = 0;
+  check_target(__func__, "staging");
+  expect(__func__, "no If-None-Match", sent_if_none_match[0] == '\0');
+  expect(__func__, "no 304", not_modified == 0);
+}
+
+int main(void) {
+  test_full_etag();
+  test_etag_too_long();
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include <stddef.h>
+
+typedef int esp_err_t;
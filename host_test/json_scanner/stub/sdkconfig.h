@@ -0,0 +1,5 @@
+#pragma once
+
+// gh_status_manager.h builds its target URLs from these
+#define CONFIG_GITHUB_USERNAME "octocat"
+#define CONFIG_GITHUB_REPO "Hello-World"
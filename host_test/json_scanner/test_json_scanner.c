@@ -0,0 +1,211 @@
+// Host test for json_scanner.c: replays recorded GitHub and Vercel responses
+// split at fixed and random chunk boundaries, the way esp_http_client hands
+// chunked and content-length bodies to the scanner, and checks that every
+// split extracts the same values as the expected log.
+#include "deploy_state.h"
+#include "gh_status_manager.h"
+#include "json_scanner.h"
+#include "scan_keys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_SIZE 1024
+#define DOC_SIZE 8192
+#define RANDOM_SPLITS 500
+#define RANDOM_MAX_CHUNK 32
+
+typedef struct {
+  char log[LOG_SIZE];
+  int stop_after; // values to take before asking to stop, 0 = never
+  int seen;
+} capture_t;
+
+// Log each callback as "<key>=<value>;", "<key>:{};" for a container value
+// and "end;" for an element close
+static bool capture_cb(void *ctx, int key_index, const char *value) {
+  capture_t *capture = (capture_t *)ctx;
+  size_t len = strlen(capture->log);
+  if (key_index == JSON_SCAN_ELEMENT_END) {
+    snprintf(capture->log + len, LOG_SIZE - len, "end;");
+  } else if (value) {
+    snprintf(capture->log + len, LOG_SIZE - len, "%d=%s;", key_index, value);
+  } else {
+    snprintf(capture->log + len, LOG_SIZE - len, "%d:{};", key_index);
+  }
+  return !capture->stop_after || ++capture->seen < capture->stop_after;
+}
+
+// The firmware's scanners' keys, from scan_keys.h
+#define X GH_GRAPHQL_ALIAS_KEY
+static const json_scan_key_t graphql_keys[] = {GH_GRAPHQL_KEYS};
+#undef X
+
+typedef struct {
+  const char *file;
+  const json_scan_key_t *keys;
+  int key_count;
+  uint8_t element_depth;
+  int stop_after;
+  const char *expected;
+  json_scan_status_t status;
+} test_case_t;
+
+#define KEYS(table) table, (int)(sizeof(table) / sizeof(table[0]))
+#define KEY(key) &key, 1
+
+static const test_case_t cases[] = {
+    // Newest deployment's id; creator.id one level down is not it
+    {"github_deployments.json", KEY(gh_rest_id_key), 0, 1, "0=1874329921;",
+     JSON_SCAN_DONE},
+    {"github_statuses.json", KEY(gh_rest_state_key), 0, 0,
+     "0=success;0=in_progress;", JSON_SCAN_MORE},
+    {"github_statuses.json", KEY(gh_rest_state_key), 0, 1, "0=success;",
+     JSON_SCAN_DONE},
+    {"github_graphql.json", KEYS(graphql_keys), 0, 0,
+     "0:{};4=1874329921;3=SUCCESS;1:{};4=1874330517;3=IN_PROGRESS;2:{};",
+     JSON_SCAN_MORE},
+    // creator.uid and meta are nested deeper than the deployment's fields
+    {"vercel_deployments.json", KEYS(vercel_target_keys), 0, 0,
+     "0:{};2=dpl_8fKq2mZr4VtXn7LpWc3sJd9Hb1Ay;1=READY;", JSON_SCAN_MORE},
+    {"vercel_batch.json", KEYS(vercel_batch_keys),
+     VERCEL_BATCH_ELEMENT_DEPTH, 0,
+     "2=dpl_3Hn8Qw2Lk5Rt9Vx1Zc4Bm7Np0Ys;1=BUILDING;0=null;end;"
+     "2=dpl_6Jt1Wp4Xr8Lm2Qz5Ks9Dv3Hb7Cn;1=QUEUED;0=staging;end;"
+     "2=dpl_8fKq2mZr4VtXn7LpWc3sJd9Hb1Ay;1=READY;0=production;end;"
+     "2=dpl_1Ab2Cd3Ef4Gh5Ij6Kl7Mn8Op9Qr;1=ERROR;0=production;end;",
+     JSON_SCAN_MORE},
+};
+
+static size_t load(const char *file, char *doc) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", CORPUS_DIR, file);
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "cannot open %s\n", path);
+    exit(2);
+  }
+  size_t len = fread(doc, 1, DOC_SIZE, f);
+  fclose(f);
+  if (len == DOC_SIZE) {
+    fprintf(stderr, "%s is larger than DOC_SIZE\n", path);
+    exit(2);
+  }
+  return len;
+}
+
+// Feed the document in chunks; chunk == 0 picks random sizes
+static json_scan_status_t replay(const test_case_t *tc, const char *doc,
+                                 size_t len, size_t chunk, capture_t *out) {
+  memset(out, 0, sizeof(*out));
+  out->stop_after = tc->stop_after;
+  json_scanner_t scanner;
+  json_scanner_init(&scanner, tc->keys, tc->key_count, tc->element_depth,
+                    capture_cb, out);
+
+  json_scan_status_t status = JSON_SCAN_MORE;
+  for (size_t pos = 0; pos < len;) {
+    size_t n = chunk ? chunk : 1 + (size_t)rand() % RANDOM_MAX_CHUNK;
+    if (n > len - pos) {
+      n = len - pos;
+    }
+    status = json_scanner_feed(&scanner, doc + pos, n);
+    pos += n;
+  }
+  return status;
+}
+
+static bool check(const test_case_t *tc, const char *split,
+                  json_scan_status_t status, const capture_t *capture) {
+  if (status == tc->status && strcmp(capture->log, tc->expected) == 0) {
+    return true;
+  }
+  fprintf(stderr, "FAIL %s (%s): status %d, want %d\n  got  %s\n  want %s\n",
+          tc->file, split, status, tc->status, capture->log, tc->expected);
+  return false;
+}
+
+// Malformed input must fail, not report values
+static int test_malformed(void) {
+  static const char *const docs[] = {
+      "[{\"id\":1}]]",
+      "]",
+      "[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[]",
+  };
+  int failures = 0;
+  for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+    capture_t capture = {0};
+    json_scanner_t scanner;
+    json_scanner_init(&scanner, KEY(gh_rest_id_key), 0, capture_cb, &capture);
+    if (json_scanner_feed(&scanner, docs[i], strlen(docs[i])) !=
+        JSON_SCAN_ERROR) {
+      fprintf(stderr, "FAIL malformed %zu: not rejected\n", i);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+// A Vercel uid copied into a DEPLOY_ID_LEN buffer, as the firmware keeps it
+// in fetch results, its batch cache and NVS records
+static bool copy_uid_cb(void *ctx, int key_index, const char *value) {
+  if (key_index == VERCEL_KEY_UID && value) {
+    snprintf((char *)ctx, DEPLOY_ID_LEN, "%s", value);
+    return false;
+  }
+  return true;
+}
+
+static int test_full_uid(char *doc) {
+  static const char uid[] = "dpl_8fKq2mZr4VtXn7LpWc3sJd9Hb1Ay";
+  char copied[DEPLOY_ID_LEN] = "";
+  size_t len = load("vercel_deployments.json", doc);
+  json_scanner_t scanner;
+  json_scanner_init(&scanner, KEYS(vercel_target_keys), 0, copy_uid_cb,
+                    copied);
+  json_scanner_feed(&scanner, doc, len);
+  if (strcmp(copied, uid) != 0) {
+    fprintf(stderr, "FAIL uid: got %s, want %s\n", copied, uid);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  unsigned seed = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 1;
+  srand(seed);
+
+  static char doc[DOC_SIZE];
+  static const size_t fixed_chunks[] = {DOC_SIZE, 1, 2, 3, 7, 64};
+  int failures = 0;
+  int runs = 0;
+
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    const test_case_t *tc = &cases[c];
+    size_t len = load(tc->file, doc);
+    capture_t capture;
+
+    for (size_t i = 0; i < sizeof(fixed_chunks) / sizeof(fixed_chunks[0]);
+         i++) {
+      char split[32];
+      snprintf(split, sizeof(split), "%zu-byte chunks", fixed_chunks[i]);
+      json_scan_status_t status =
+          replay(tc, doc, len, fixed_chunks[i], &capture);
+      failures += !check(tc, split, status, &capture);
+      runs++;
+    }
+    for (int i = 0; i < RANDOM_SPLITS; i++) {
+      json_scan_status_t status = replay(tc, doc, len, 0, &capture);
+      if (!check(tc, "random chunks", status, &capture)) {
+        failures++;
+        break; // one report per case is enough
+      }
+      runs++;
+    }
+  }
+  failures += test_malformed();
+  failures += test_full_uid(doc);
+
+  printf("%d replays, seed %u, %d failures\n", runs, seed, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Only the types http_conn_manager.h names
+typedef enum { HTTP_METHOD_GET, HTTP_METHOD_POST } esp_http_client_method_t;
+typedef struct esp_http_client_event esp_http_client_event_t;
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
@@ -0,0 +1,12 @@
+#pragma once
+
+// Intervals chosen so the budget spacing, fast interval and base interval
+// all differ
+#define CONFIG_STATUS_CHECK_INTERVAL 60
+#define CONFIG_POLL_FAST_INTERVAL 30
+#define CONFIG_POLL_MAX_INTERVAL 900
+#define CONFIG_POLL_MIN_INTERVAL 10
+#define CONFIG_RATE_LIMIT_RESERVE_PERCENT 10
+#define CONFIG_WEBHOOK_RECONCILE_INTERVAL 600
+#define CONFIG_GITHUB_AUTH_TOKEN "test"
+#define CONFIG_VERCEL_AUTH_TOKEN "test"
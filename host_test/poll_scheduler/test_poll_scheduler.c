@@ -0,0 +1,144 @@
+// Host test for poll_scheduler.c: feeds rate-limit budgets and poll results
+// and checks that the budget only spaces cycles out or brings a deployment in
+// flight forward, never a settled environment before its own cadence. Built
+// once as a polling panel and once with CONFIG_WEBHOOK_ENABLE.
+#include "../../main/poll_scheduler.c"
+#include <stdio.h>
+
+#define WALL_CLOCK 1700000000 // get_real_time() for every test
+#define START_MS 1000000
+
+static http_conn_stats_t cycle_stats[HTTP_HOST_COUNT];
+static int failures = 0;
+static int checks = 0;
+
+time_t get_real_time(void) { return WALL_CLOCK; }
+
+void http_conn_get_cycle_stats(http_host_t host, http_conn_stats_t *stats) {
+  *stats = cycle_stats[host];
+}
+
+const char *http_conn_host_name(http_host_t host) {
+  return host == HTTP_HOST_GITHUB ? "GITHUB" : "VERCEL";
+}
+
+static void reset(void) {
+  memset(cadences, 0, sizeof(cadences));
+  memset(rate_limits, 0, sizeof(rate_limits));
+  memset(cycle_stats, 0, sizeof(cycle_stats));
+}
+
+// GitHub reports remaining requests, reset in reset_s, after a cycle that
+// made requests of which not_modified were answered 304
+static void set_budget(const char *remaining, int reset_s, uint32_t requests,
+                       uint32_t not_modified) {
+  char reset_at[24];
+  snprintf(reset_at, sizeof(reset_at), "%d", WALL_CLOCK + reset_s);
+  poll_scheduler_note_header(HTTP_HOST_GITHUB, "X-RateLimit-Remaining",
+                             remaining);
+  poll_scheduler_note_header(HTTP_HOST_GITHUB, "X-RateLimit-Reset", reset_at);
+  cycle_stats[HTTP_HOST_GITHUB].requests = requests;
+  cycle_stats[HTTP_HOST_GITHUB].not_modified = not_modified;
+}
+
+static void expect(const char *test, const char *what, int64_t got,
+                   int64_t want) {
+  checks++;
+  if (got != want) {
+    fprintf(stderr, "FAIL %s: %s %lld, want %lld\n", test, what,
+            (long long)got, (long long)want);
+    failures++;
+  }
+}
+
+static int64_t max_ms(int64_t a, int64_t b) { return a > b ? a : b; }
+
+// 5000 requests left for the hour and one per cycle: a 10 s spacing that a
+// settled environment must not be pulled forward to
+static void test_terminal_keeps_cadence(void) {
+  reset();
+  poll_scheduler_env_update(0, DEPLOY_STATE_SUCCESS, START_MS);
+  set_budget("5000", 3600, 1, 0);
+
+  expect(__func__, "delay", poll_scheduler_next_delay_ms(START_MS),
+         POLL_BASE_INTERVAL * 1000);
+  expect(__func__, "due before its cadence",
+         poll_scheduler_env_due(0, START_MS + POLL_BASE_INTERVAL * 1000 - 1),
+         false);
+  expect(__func__, "due at its cadence",
+         poll_scheduler_env_due(0, START_MS + POLL_BASE_INTERVAL * 1000), true);
+}
+
+// Unchanged terminal polls keep doubling to the maximum with budget to spare
+static void test_backoff_survives_budget(void) {
+  reset();
+  int64_t now_ms = START_MS;
+  int64_t interval_s = POLL_BASE_INTERVAL;
+  for (int i = 0; i < 6; i++) {
+    poll_scheduler_env_update(0, DEPLOY_STATE_SUCCESS, now_ms);
+    set_budget("5000", 3600, 1, 0);
+    uint32_t delay_ms = poll_scheduler_next_delay_ms(now_ms);
+    expect(__func__, "delay", delay_ms, interval_s * 1000);
+    now_ms += delay_ms;
+    interval_s = interval_s * 2 > CONFIG_POLL_MAX_INTERVAL
+                     ? max_ms(CONFIG_POLL_MAX_INTERVAL, POLL_BASE_INTERVAL)
+                     : interval_s * 2;
+  }
+}
+
+// A deployment in flight is polled at the spacing when that is sooner than
+// its own interval, but not on a webhook panel
+static void test_transient_at_spacing(void) {
+  reset();
+  poll_scheduler_env_update(0, DEPLOY_STATE_IN_PROGRESS, START_MS);
+  poll_scheduler_env_update(1, DEPLOY_STATE_SUCCESS, START_MS);
+  set_budget("5000", 3600, 2, 0);
+
+#ifdef CONFIG_WEBHOOK_ENABLE
+  int64_t want_ms = POLL_TRANSIENT_INTERVAL * 1000;
+#else
+  int64_t want_ms = CONFIG_POLL_MIN_INTERVAL * 1000;
+#endif
+  expect(__func__, "delay", poll_scheduler_next_delay_ms(START_MS), want_ms);
+  expect(__func__, "settled environment due",
+         poll_scheduler_env_due(1, START_MS + want_ms),
+         want_ms >= POLL_BASE_INTERVAL * 1000);
+}
+
+// 45 left, 40 after the reserve, 4 per cycle: 10 cycles in an hour, 360 s
+// apart, even with an environment overdue
+static void test_spacing_floor(void) {
+  reset();
+  poll_scheduler_env_update(0, DEPLOY_STATE_SUCCESS, START_MS);
+  set_budget("45", 3600, 4, 0);
+
+  int64_t now_ms = START_MS + POLL_BASE_INTERVAL * 1000 + 1;
+  expect(__func__, "overdue delay", poll_scheduler_next_delay_ms(now_ms),
+         360000);
+}
+
+// The same cycle answered entirely with 304s cost nothing
+static void test_not_modified_free(void) {
+  reset();
+  poll_scheduler_env_update(0, DEPLOY_STATE_SUCCESS, START_MS);
+  set_budget("45", 3600, 4, 4);
+
+  expect(__func__, "delay", poll_scheduler_next_delay_ms(START_MS),
+         POLL_BASE_INTERVAL * 1000);
+}
+
+int main(void) {
+  test_terminal_keeps_cadence();
+  test_backoff_survives_budget();
+  test_transient_at_spacing();
+  test_spacing_floor();
+  test_not_modified_free();
+
+#ifdef CONFIG_WEBHOOK_ENABLE
+  const char *variant = "webhook";
+#else
+  const char *variant = "polling";
+#endif
+  printf("%s: %d checks, %d failures\n", variant, checks, failures);
+  return failures ? 1 : 0;
+}
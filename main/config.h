@@ -17,9 +17,6 @@
 
 #define BOARD_HAS_TOUCH 0
 
-#define DISPLAY_BUFFER_SIZE (AMOLED_WIDTH * 100)
-
-#define DISPLAY_FULLRESH false
 #define LCD_SWAP_XY (false)
 #define LCD_MIRROR_X (false)
 #define LCD_MIRROR_Y (false)
@@ -0,0 +1,66 @@
+#include "deploy_state.h"
+#include "esp_log.h"
+#include "string.h"
+#include <ctype.h>
+#include <strings.h>
+
+static const char *TAG = "DEPLOY_STATE";
+
+#define X(state, label, rgb, kind) {label, rgb, kind},
+static const struct {
+  const char *label;
+  uint32_t rgb;
+  uint8_t kind;
+} state_info[DEPLOY_STATE_COUNT] = {DEPLOY_STATES};
+#undef X
+
+// Lengths are computed at build time, so a lookup only compares the strings
+// whose length and first letter already match. A switch generated from
+// DEPLOY_STATE_NAMES is not possible: a string literal's characters are not
+// integer constant expressions in C, and lengths alone repeat (four names
+// have 7 letters), so neither makes unique case labels.
+#define X(raw, state) {raw, sizeof(raw) - 1, DEPLOY_STATE_##state},
+static const struct {
+  const char *raw;
+  uint8_t len;
+  deploy_state_t state;
+} state_names[] = {DEPLOY_STATE_NAMES};
+#undef X
+
+deploy_state_t deploy_state_parse(const char *raw) {
+  if (!raw || !raw[0]) {
+    return DEPLOY_STATE_UNKNOWN;
+  }
+
+  size_t len = strlen(raw);
+  char first = (char)tolower((unsigned char)raw[0]);
+  for (size_t i = 0; i < sizeof(state_names) / sizeof(state_names[0]); i++) {
+    if (state_names[i].len == len && state_names[i].raw[0] == first &&
+        strcasecmp(state_names[i].raw, raw) == 0) {
+      return state_names[i].state;
+    }
+  }
+
+  ESP_LOGW(TAG, "Unrecognized state '%s'", raw);
+  return DEPLOY_STATE_UNKNOWN;
+}
+
+const char *deploy_state_label(deploy_state_t state) {
+  return state < DEPLOY_STATE_COUNT ? state_info[state].label : "unknown";
+}
+
+uint32_t deploy_state_color(deploy_state_t state) {
+  return state_info[state < DEPLOY_STATE_COUNT ? state
+                                               : DEPLOY_STATE_UNKNOWN]
+      .rgb;
+}
+
+bool deploy_state_is_transient(deploy_state_t state) {
+  return state < DEPLOY_STATE_COUNT &&
+         state_info[state].kind == DEPLOY_KIND_TRANSIENT;
+}
+
+bool deploy_state_is_terminal(deploy_state_t state) {
+  return state < DEPLOY_STATE_COUNT &&
+         state_info[state].kind == DEPLOY_KIND_TERMINAL;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Kinds of deployment state, for the poll scheduler and deployment caches
+#define DEPLOY_KIND_OPEN 0      // unknown; poll at the base cadence
+#define DEPLOY_KIND_TRANSIENT 1 // still moving on its own; poll fast
+#define DEPLOY_KIND_TERMINAL 2  // this deployment will not change again
+
+// Longest provider deployment ID: a Vercel uid is "dpl_" and 28 characters;
+// GitHub IDs are 64-bit numbers, at most 20 digits
+#define DEPLOY_ID_MAX_CHARS 32
+// Provider's deployment ID as text (GitHub numeric ID, Vercel uid), with NUL
+// and room for a longer uid format
+#define DEPLOY_ID_LEN 40
+_Static_assert(DEPLOY_ID_LEN > DEPLOY_ID_MAX_CHARS,
+               "deployment IDs must fit with their NUL");
+
+// X(state, label, rgb, kind): every state shown on the panel
+#define DEPLOY_STATES                                                          \
+  X(UNKNOWN, "unknown", 0x808080, DEPLOY_KIND_OPEN)                            \
+  X(NONE, "no deployments", 0xFFFF00, DEPLOY_KIND_OPEN)                        \
+  X(PENDING, "pending", 0x808080, DEPLOY_KIND_TRANSIENT)                       \
+  X(QUEUED, "queued", 0x808080, DEPLOY_KIND_TRANSIENT)                         \
+  X(WAITING, "waiting", 0xFFFF00, DEPLOY_KIND_TRANSIENT)                       \
+  X(IN_PROGRESS, "in progress", 0x808080, DEPLOY_KIND_TRANSIENT)               \
+  X(SUCCESS, "success", 0x00FF00, DEPLOY_KIND_TERMINAL)                        \
+  X(FAILURE, "failure", 0xFF0000, DEPLOY_KIND_TERMINAL)                        \
+  X(ERROR, "error", 0xFF0000, DEPLOY_KIND_TERMINAL)                            \
+  X(CANCELED, "canceled", 0xFFFF00, DEPLOY_KIND_OPEN)                          \
+  X(INACTIVE, "inactive", 0x808080, DEPLOY_KIND_OPEN)
+
+// X(raw, state): provider strings, matched case-insensitively. GitHub REST
+// and GraphQL deployment status states, then Vercel readyState values.
+#define DEPLOY_STATE_NAMES                                                     \
+  X("success", SUCCESS)                                                        \
+  X("failure", FAILURE)                                                        \
+  X("error", ERROR)                                                            \
+  X("pending", PENDING)                                                        \
+  X("queued", QUEUED)                                                          \
+  X("waiting", WAITING)                                                        \
+  X("in_progress", IN_PROGRESS)                                                \
+  X("inactive", INACTIVE)                                                      \
+  X("ready", SUCCESS)                                                          \
+  X("building", IN_PROGRESS)                                                   \
+  X("initializing", IN_PROGRESS)                                               \
+  X("canceled", CANCELED)
+
+#define X(state, label, rgb, kind) DEPLOY_STATE_##state,
+typedef enum { DEPLOY_STATES DEPLOY_STATE_COUNT } deploy_state_t;
+#undef X
+
+/**
+ * @brief Map a provider's state string to a deploy_state_t
+ *
+ * @return deploy_state_t DEPLOY_STATE_UNKNOWN for strings not in
+ * DEPLOY_STATE_NAMES
+ */
+deploy_state_t deploy_state_parse(const char *raw);
+
+/**
+ * @brief Text shown on the panel for a state
+ */
+const char *deploy_state_label(deploy_state_t state);
+
+/**
+ * @brief Panel color for a state, 0xRRGGBB
+ */
+uint32_t deploy_state_color(deploy_state_t state);
+
+/**
+ * @brief States a deployment can still move out of on its own
+ */
+bool deploy_state_is_transient(deploy_state_t state);
+
+/**
+ * @brief States a deployment never leaves
+ */
+bool deploy_state_is_terminal(deploy_state_t state);
@@ -0,0 +1,98 @@
+#include "display_bench.h"
+#include "display_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+
+#ifdef CONFIG_DISPLAY_BENCHMARK
+static const char *TAG = "display_bench";
+
+#define X(name, full, dbl, lines, mhz) {#name, full, dbl, lines, mhz},
+static const display_profile_t bench_profiles[] = {DISPLAY_BENCH_PROFILES};
+#undef X
+
+// A typical panel: three targets in different states and the clock strip
+static const char *const bench_names[] = {"production", "staging", "preview"};
+#define BENCH_ROWS ((int)(sizeof(bench_names) / sizeof(bench_names[0])))
+
+typedef struct {
+  uint32_t frame_us; // wall time of display_manager_refresh_now
+  uint32_t render_us;
+  uint32_t flush_us;
+  uint32_t bytes;
+} bench_result_t;
+
+static void draw_status_screen(void) {
+  display_manager_set_bg_color(0, 0, 0);
+  display_manager_dashboard_create(bench_names, BENCH_ROWS, TEXT_SIZE_22);
+  display_manager_dashboard_set(0, "success", 0, 255, 0);
+  display_manager_dashboard_set(1, "in progress", 128, 128, 128);
+  display_manager_dashboard_set(2, "failure", 255, 0, 0);
+  display_manager_dashboard_set_bottom("checked: 12:00:00");
+}
+
+// Average cost of one refresh over DISPLAY_BENCH_FRAMES
+static void time_frames(bool full_screen, bench_result_t *result) {
+  display_stats_t before;
+  display_stats_t after;
+  display_manager_get_stats(&before);
+
+  int64_t elapsed_us = 0;
+  for (int i = 0; i < DISPLAY_BENCH_FRAMES; i++) {
+    if (!full_screen) {
+      // What a poll cycle changes: one status and the clock
+      char clock[32];
+      snprintf(clock, sizeof(clock), "checked: 12:00:%02d", i);
+      display_manager_dashboard_set_bottom(clock);
+      display_manager_dashboard_set(1, i % 2 ? "in progress" : "success",
+                                    i % 2 ? 128 : 0, i % 2 ? 128 : 255,
+                                    i % 2 ? 128 : 0);
+    }
+    int64_t start_us = esp_timer_get_time();
+    display_manager_refresh_now(full_screen);
+    elapsed_us += esp_timer_get_time() - start_us;
+  }
+
+  display_manager_get_stats(&after);
+  result->frame_us = (uint32_t)(elapsed_us / DISPLAY_BENCH_FRAMES);
+  result->render_us =
+      (uint32_t)((after.render_us - before.render_us) / DISPLAY_BENCH_FRAMES);
+  result->flush_us =
+      (uint32_t)((after.flush_us - before.flush_us) / DISPLAY_BENCH_FRAMES);
+  result->bytes = (uint32_t)((after.flushed_bytes - before.flushed_bytes) /
+                             DISPLAY_BENCH_FRAMES);
+}
+
+esp_err_t display_bench_run(void) {
+  ESP_LOGI(TAG, "%-18s %8s | %25s | %25s", "profile", "RAM",
+           "full repaint us (r/f)", "status update us (r/f)");
+
+  for (size_t i = 0; i < sizeof(bench_profiles) / sizeof(bench_profiles[0]);
+       i++) {
+    const display_profile_t *profile = &bench_profiles[i];
+    size_t ram_bytes = 0;
+    if (display_manager_set_profile(profile, &ram_bytes) != ESP_OK) {
+      ESP_LOGW(TAG, "%-18s does not fit", profile->name);
+      continue;
+    }
+
+    draw_status_screen();
+    display_manager_refresh_now(true); // settle layout before timing
+
+    bench_result_t full;
+    bench_result_t update;
+    time_frames(true, &full);
+    time_frames(false, &update);
+
+    ESP_LOGI(TAG,
+             "%-18s %8u | %7lu (%6lu/%6lu) | %7lu (%6lu/%6lu) %lu B/update",
+             profile->name, (unsigned)ram_bytes, (unsigned long)full.frame_us,
+             (unsigned long)full.render_us, (unsigned long)full.flush_us,
+             (unsigned long)update.frame_us, (unsigned long)update.render_us,
+             (unsigned long)update.flush_us, (unsigned long)update.bytes);
+  }
+
+  const display_profile_t profile = DISPLAY_PROFILE_DEFAULT;
+  return display_manager_set_profile(&profile, NULL);
+}
+#endif // CONFIG_DISPLAY_BENCHMARK
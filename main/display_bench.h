@@ -0,0 +1,30 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+// X(name, full_refresh, double_buffer, buffer_lines, pclk_mhz)
+#define DISPLAY_BENCH_PROFILES                                                 \
+  X(partial_1x20_27, false, false, 20, 27)                                     \
+  X(partial_2x20_27, false, true, 20, 27)                                      \
+  X(partial_1x50_27, false, false, 50, 27)                                     \
+  X(partial_2x50_27, false, true, 50, 27)                                      \
+  X(partial_2x100_27, false, true, 100, 27)                                    \
+  X(partial_2x50_40, false, true, 50, 40)                                      \
+  X(partial_2x100_40, false, true, 100, 40)                                    \
+  X(full_1x_40, true, false, 0, 40)                                            \
+  X(full_2x_40, true, true, 0, 40)
+
+// Repaints timed per profile and kind
+#define DISPLAY_BENCH_FRAMES 10
+
+/**
+ * @brief Time every profile in DISPLAY_BENCH_PROFILES and log the results
+ *
+ * Each profile repaints a sample status screen: DISPLAY_BENCH_FRAMES full
+ * repaints, then as many single-row updates with a changing clock. Logs the
+ * internal RAM the profile takes and the average frame, render and flush
+ * times, then switches back to the menuconfig profile. Call after
+ * display_manager_init(); anything on screen is discarded.
+ */
+esp_err_t display_bench_run(void);
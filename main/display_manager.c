@@ -1,24 +1,219 @@
 #include "display_manager.h"
-#include "config.h"
 #include "display/lv_display.h"
-#include "driver/gpio.h"
+#include "display_port.h"
 #include "esp_err.h"
-#include "esp_lcd_panel_io.h"
-#include "esp_lcd_panel_ops.h"
-#include "esp_lcd_panel_vendor.h"
-#include "esp_lcd_types.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
-#include "esp_lvgl_port.h"
+#include "esp_timer.h"
 #include "font/lv_font.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "misc/lv_color.h"
 #include "sdkconfig.h"
+#include "string.h"
+#include <stdatomic.h>
 
+// With CONFIG_DISPLAY_TILES, display_tiles.c implements display_manager.h
+#ifndef CONFIG_DISPLAY_TILES
 static const char *TAG = "display_manager";
-static esp_lcd_panel_io_handle_t io_handle = NULL;
-static esp_lcd_panel_handle_t panel_handle = NULL;
 static lv_disp_t *disp_handle = NULL;
 static lv_obj_t *main_content_container = NULL;
 
+// Retained dashboard: labels live until display_manager_clear()
+typedef struct {
+  lv_obj_t *name;
+  lv_obj_t *value;
+  lv_color_t color;
+} dashboard_row_t;
+
+static const char *const *dashboard_names = NULL;
+static dashboard_row_t dashboard_rows[DISPLAY_DASHBOARD_MAX_ROWS];
+static int dashboard_row_count = 0;
+static lv_obj_t *dashboard_bottom = NULL;
+// Rows that fit above the bottom strip are shown a page at a time
+static int dashboard_page_rows = 1;
+static int dashboard_page = 0;
+static esp_timer_handle_t page_timer = NULL;
+
+// Public calls only queue a command; drain_task applies them in batches, so
+// callers never wait for a frame to render. The page timer does not queue.
+typedef enum {
+  DISPLAY_CMD_SET_BG_COLOR,
+  DISPLAY_CMD_CLEAR,
+  DISPLAY_CMD_WRITE_TEXT,
+  DISPLAY_CMD_WRITE_TEXT_BOTTOM,
+  DISPLAY_CMD_DASHBOARD_CREATE,
+  DISPLAY_CMD_DASHBOARD_SET,
+  DISPLAY_CMD_DASHBOARD_SET_NOTE,
+  DISPLAY_CMD_DASHBOARD_SET_BOTTOM,
+} display_cmd_type_t;
+
+typedef struct {
+  display_cmd_type_t type;
+  lv_color_t color;
+  uint8_t size; // enum text_size, 0 for the default font
+  int16_t row;  // dashboard row, or row count for DASHBOARD_CREATE
+  const char *const *names;
+  char text[DISPLAY_CMD_TEXT_LEN];
+} display_cmd_t;
+
+// Lock-free single-producer, single-consumer ring. Only the task calling
+// display_manager moves cmd_head; only the LVGL lock holder moves cmd_tail.
+// Both count up forever and wrap with unsigned arithmetic.
+_Static_assert((DISPLAY_CMD_QUEUE_LENGTH & (DISPLAY_CMD_QUEUE_LENGTH - 1)) ==
+                   0,
+               "ring indices wrap cleanly at a power of two");
+static display_cmd_t cmd_ring[DISPLAY_CMD_QUEUE_LENGTH];
+static atomic_uint cmd_head = 0;
+static atomic_uint cmd_tail = 0;
+// Given when a drain frees slots, for a producer waiting on a full ring
+static SemaphoreHandle_t cmd_space = NULL;
+// Set by the page timer instead of queuing, so callers stay the only producer
+static atomic_bool next_page_pending = false;
+static TaskHandle_t drain_task_handle = NULL;
+
+#ifdef CONFIG_DISPLAY_STATS
+static display_stats_t stats;
+// Read from any task, updated from the LVGL task and lock holders
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Frame being invalidated and rendered; only touched with the LVGL lock held
+static struct {
+  int64_t refr_start_us;
+  int64_t flush_start_us; // current flush callback or DMA wait
+  uint32_t flush_wait_us;
+  uint32_t areas;
+  uint32_t invalidated_px;
+  uint32_t flushes;
+  uint32_t px;
+} frame;
+
+static void display_event_cb(lv_event_t *e) {
+  int64_t now_us = esp_timer_get_time();
+  const lv_area_t *area = (const lv_area_t *)lv_event_get_param(e);
+
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_INVALIDATE_AREA:
+    frame.areas++;
+    frame.invalidated_px += lv_area_get_size(area);
+    break;
+  case LV_EVENT_REFR_START:
+    frame.refr_start_us = now_us;
+    break;
+  case LV_EVENT_FLUSH_START:
+    frame.flushes++;
+    frame.px += lv_area_get_size(area);
+    frame.flush_start_us = now_us;
+    break;
+  case LV_EVENT_FLUSH_WAIT_START:
+    frame.flush_start_us = now_us;
+    break;
+  case LV_EVENT_FLUSH_FINISH:
+  case LV_EVENT_FLUSH_WAIT_FINISH:
+    frame.flush_wait_us += (uint32_t)(now_us - frame.flush_start_us);
+    break;
+  case LV_EVENT_REFR_READY: {
+    if (frame.flushes == 0) {
+      break; // nothing was dirty; keep counting invalidations
+    }
+    uint32_t frame_us = (uint32_t)(now_us - frame.refr_start_us);
+    uint32_t bytes = frame.px * lv_color_format_get_size(
+                                    lv_display_get_color_format(disp_handle));
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats.frames++;
+    stats.invalidated_areas += frame.areas;
+    stats.invalidated_px += frame.invalidated_px;
+    stats.flushes += frame.flushes;
+    stats.flushed_px += frame.px;
+    stats.flushed_bytes += bytes;
+    stats.last_frame_bytes = bytes;
+    if (bytes > stats.max_frame_bytes) {
+      stats.max_frame_bytes = bytes;
+    }
+    stats.flush_wait_us += frame.flush_wait_us;
+    // A transfer still running now is counted with the next frame
+    stats.flush_us += display_port_take_flush_us();
+    stats.render_us +=
+        frame_us > frame.flush_wait_us ? frame_us - frame.flush_wait_us : 0;
+    stats.last_frame_us = frame_us;
+    if (frame_us > stats.max_frame_us) {
+      stats.max_frame_us = frame_us;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    memset(&frame, 0, sizeof(frame));
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+#if CONFIG_DISPLAY_STATS_LOG_INTERVAL > 0
+static void stats_log_cb(void *arg) {
+  static display_stats_t last;
+  display_stats_t now;
+  display_manager_get_stats(&now);
+
+  ESP_LOGI(TAG,
+           "%lu frames, %lu areas, %llu px / %llu B flushed (max %lu B), "
+           "render %llu ms, flush %llu ms (waited %llu ms, max frame %lu us), "
+           "%lu commands (max batch %lu), lock wait %llu ms (max %lu us)",
+           (unsigned long)(now.frames - last.frames),
+           (unsigned long)(now.invalidated_areas - last.invalidated_areas),
+           (unsigned long long)(now.flushed_px - last.flushed_px),
+           (unsigned long long)(now.flushed_bytes - last.flushed_bytes),
+           (unsigned long)now.max_frame_bytes,
+           (unsigned long long)((now.render_us - last.render_us) / 1000),
+           (unsigned long long)((now.flush_us - last.flush_us) / 1000),
+           (unsigned long long)((now.flush_wait_us - last.flush_wait_us) /
+                                1000),
+           (unsigned long)now.max_frame_us,
+           (unsigned long)(now.commands - last.commands),
+           (unsigned long)now.max_batch,
+           (unsigned long long)((now.lock_wait_us - last.lock_wait_us) / 1000),
+           (unsigned long)now.max_lock_wait_us);
+  last = now;
+}
+#endif
+#endif // CONFIG_DISPLAY_STATS
+
+// display_port_lock, counting how long callers wait for the LVGL task
+static bool display_lock(void) {
+#ifdef CONFIG_DISPLAY_STATS
+  int64_t start_us = esp_timer_get_time();
+  bool locked = display_port_lock();
+  uint32_t waited_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+  taskENTER_CRITICAL(&stats_lock);
+  stats.lock_waits++;
+  stats.lock_wait_us += waited_us;
+  if (waited_us > stats.max_lock_wait_us) {
+    stats.max_lock_wait_us = waited_us;
+  }
+  taskEXIT_CRITICAL(&stats_lock);
+  return locked;
+#else
+  return display_port_lock();
+#endif
+}
+
+esp_err_t display_manager_get_stats(display_stats_t *out) {
+#ifdef CONFIG_DISPLAY_STATS
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  taskENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  taskEXIT_CRITICAL(&stats_lock);
+  return ESP_OK;
+#else
+  return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 static void create_main_content_container(void) {
   if (main_content_container) {
     lv_obj_del(main_content_container);
@@ -109,209 +304,483 @@ const lv_font_t *get_font(enum text_size size) {
   }
 }
 
-esp_err_t display_manager_set_bg_color(uint8_t r, uint8_t g, uint8_t b) {
-  if (lvgl_port_lock(0)) {
-    static lv_style_t style_scr;
-    lv_style_init(&style_scr);
-    lv_style_set_bg_color(&style_scr, lv_color_make(r, g, b));
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_add_style(scr, &style_scr, LV_STATE_DEFAULT);
-    lvgl_port_unlock();
-    return ESP_OK;
-  }
-  return ESP_FAIL;
+// Call with the LVGL port lock held
+static lv_obj_t *create_bottom_label(const char *text) {
+  lv_obj_t *scr = lv_scr_act();
+
+  // Get screen dimensions
+  lv_coord_t screen_width = lv_disp_get_hor_res(disp_handle);
+  lv_coord_t screen_height = lv_disp_get_ver_res(disp_handle);
+
+  // Create a container for the bottom text that bypasses flex layout
+  lv_obj_t *bottom_container = lv_obj_create(scr);
+  lv_obj_remove_style_all(bottom_container);
+  lv_obj_set_size(bottom_container, screen_width,
+                  CONFIG_BOTTOM_TEXT_HEIGHT); // Fixed height for bottom text
+
+  // Position container at the very bottom using absolute coordinates
+  lv_obj_set_pos(bottom_container, 0,
+                 screen_height - CONFIG_BOTTOM_TEXT_HEIGHT);
+
+  // Create a label inside the container
+  lv_obj_t *label = lv_label_create(bottom_container);
+  lv_label_set_text(label, text);
+  lv_obj_set_width(label, screen_width);
+  lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
+
+  // Set text color to white
+  lv_obj_set_style_text_color(label, lv_color_white(), 0);
+  return label;
 }
 
-esp_err_t display_manager_clear(void) {
-  if (lvgl_port_lock(0)) {
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_clean(scr);
+// Commands below run in the LVGL task with the port lock held
 
-    // Recreate the main content container
+static void apply_set_bg_color(lv_color_t color) {
+  static lv_style_t style_scr;
+  lv_style_init(&style_scr);
+  lv_style_set_bg_color(&style_scr, color);
+  lv_obj_t *scr = lv_scr_act();
+  lv_obj_add_style(scr, &style_scr, LV_STATE_DEFAULT);
+}
+
+static void apply_clear(void) {
+  lv_obj_t *scr = lv_scr_act();
+  lv_obj_clean(scr);
+  main_content_container = NULL; // deleted with the screen's children
+  dashboard_row_count = 0;
+  dashboard_bottom = NULL;
+  esp_timer_stop(page_timer);
+
+  // Recreate the main content container
+  create_main_content_container();
+}
+
+static void apply_write_text(const display_cmd_t *cmd) {
+  // Ensure main content container exists
+  if (!main_content_container) {
     create_main_content_container();
+  }
+
+  lv_obj_t *label = lv_label_create(main_content_container);
+  lv_label_set_text(label, cmd->text);
+  lv_obj_set_style_text_color(label, cmd->color, 0);
 
-    lvgl_port_unlock();
-    return ESP_OK;
+  // Size 0 keeps the theme's default font
+  if (cmd->size) {
+    const lv_font_t *font = get_font((enum text_size)cmd->size);
+    lv_obj_set_style_text_font(label, font, 0);
   }
-  return ESP_FAIL;
 }
 
-esp_err_t display_manager_write_text(const char *text) {
-  if (lvgl_port_lock(0)) {
-    // Ensure main content container exists
-    if (!main_content_container) {
-      create_main_content_container();
+// Hide the rows of other pages; the column closes up around them
+static void show_dashboard_page(int page) {
+  dashboard_page = page;
+  for (int i = 0; i < dashboard_row_count; i++) {
+    bool shown = i / dashboard_page_rows == page;
+    if (shown == lv_obj_has_flag(dashboard_rows[i].name, LV_OBJ_FLAG_HIDDEN)) {
+      if (shown) {
+        lv_obj_remove_flag(dashboard_rows[i].name, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_remove_flag(dashboard_rows[i].value, LV_OBJ_FLAG_HIDDEN);
+      } else {
+        lv_obj_add_flag(dashboard_rows[i].name, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_flag(dashboard_rows[i].value, LV_OBJ_FLAG_HIDDEN);
+      }
     }
+  }
+}
 
-    lv_obj_t *label = lv_label_create(main_content_container);
-    lv_label_set_text(label, text);
+static void apply_dashboard_next_page(void) {
+  int pages = (dashboard_row_count + dashboard_page_rows - 1) /
+              dashboard_page_rows;
+  if (pages > 1) {
+    show_dashboard_page((dashboard_page + 1) % pages);
+  }
+}
 
-    // Set text color to white
-    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+static void apply_dashboard_create(const display_cmd_t *cmd) {
+  lv_obj_clean(lv_scr_act());
+  main_content_container = NULL;
+  create_main_content_container();
+
+  const lv_font_t *value_font = get_font((enum text_size)cmd->size);
+  dashboard_names = cmd->names;
+  for (int i = 0; i < cmd->row; i++) {
+    dashboard_rows[i].name = lv_label_create(main_content_container);
+    lv_label_set_text(dashboard_rows[i].name, cmd->names[i]);
+    lv_obj_set_style_text_color(dashboard_rows[i].name, lv_color_white(), 0);
+
+    // Values start empty; the first set fills them in
+    dashboard_rows[i].value = lv_label_create(main_content_container);
+    lv_label_set_text(dashboard_rows[i].value, "");
+    lv_obj_set_style_text_font(dashboard_rows[i].value, value_font, 0);
+    dashboard_rows[i].color = lv_color_white();
+    lv_obj_set_style_text_color(dashboard_rows[i].value,
+                                dashboard_rows[i].color, 0);
+  }
+  dashboard_row_count = cmd->row;
+  dashboard_bottom = create_bottom_label("");
+
+  int row_h = lv_font_get_line_height(lv_font_get_default()) +
+              lv_font_get_line_height(value_font);
+  dashboard_page_rows =
+      (lv_disp_get_ver_res(disp_handle) - CONFIG_BOTTOM_TEXT_HEIGHT) / row_h;
+  if (dashboard_page_rows < 1) {
+    dashboard_page_rows = 1;
+  }
+  show_dashboard_page(0);
+  esp_timer_stop(page_timer);
+  if (dashboard_row_count > dashboard_page_rows) {
+    esp_timer_start_periodic(
+        page_timer, (uint64_t)CONFIG_DISPLAY_DASHBOARD_PAGE_SECONDS * 1000000);
+  }
+}
+
+static void apply_dashboard_set(const display_cmd_t *cmd) {
+  if (cmd->row >= dashboard_row_count) {
+    return; // dashboard cleared or recreated smaller since the call
+  }
 
-    lvgl_port_unlock();
-    return ESP_OK;
+  // Setting a style or text invalidates the label even when it is the same,
+  // so compare first
+  dashboard_row_t *entry = &dashboard_rows[cmd->row];
+  if (strcmp(lv_label_get_text(entry->value), cmd->text) != 0) {
+    lv_label_set_text(entry->value, cmd->text);
+  }
+  if (!lv_color_eq(entry->color, cmd->color)) {
+    entry->color = cmd->color;
+    lv_obj_set_style_text_color(entry->value, cmd->color, 0);
   }
-  return ESP_FAIL;
 }
 
-esp_err_t display_manager_write_text_color(const char *text, int16_t r,
-                                           int16_t g, int16_t b) {
-  if (lvgl_port_lock(0)) {
-    // Ensure main content container exists
-    if (!main_content_container) {
-      create_main_content_container();
-    }
+static void apply_dashboard_set_note(const display_cmd_t *cmd) {
+  if (cmd->row >= dashboard_row_count) {
+    return;
+  }
 
-    lv_obj_t *label = lv_label_create(main_content_container);
-    lv_label_set_text(label, text);
+  lv_obj_t *name = dashboard_rows[cmd->row].name;
+  char text[DISPLAY_CMD_TEXT_LEN];
+  strlcpy(text, dashboard_names[cmd->row], sizeof(text));
+  if (cmd->text[0]) {
+    strlcat(text, "  ", sizeof(text));
+    strlcat(text, cmd->text, sizeof(text));
+  }
+  if (strcmp(lv_label_get_text(name), text) != 0) {
+    lv_label_set_text(name, text);
+    lv_obj_set_style_text_color(
+        name, cmd->text[0] ? lv_color_make(128, 128, 128) : lv_color_white(),
+        0);
+  }
+}
 
-    // Set text color using provided RGB values
-    lv_color_t text_color = lv_color_make(r, g, b);
-    lv_obj_set_style_text_color(label, text_color, 0);
+static void apply_dashboard_set_bottom(const display_cmd_t *cmd) {
+  if (dashboard_bottom &&
+      strcmp(lv_label_get_text(dashboard_bottom), cmd->text) != 0) {
+    lv_label_set_text(dashboard_bottom, cmd->text);
+  }
+}
 
-    lvgl_port_unlock();
-    return ESP_OK;
+static void apply_cmd(const display_cmd_t *cmd) {
+  switch (cmd->type) {
+  case DISPLAY_CMD_SET_BG_COLOR:
+    apply_set_bg_color(cmd->color);
+    break;
+  case DISPLAY_CMD_CLEAR:
+    apply_clear();
+    break;
+  case DISPLAY_CMD_WRITE_TEXT:
+    apply_write_text(cmd);
+    break;
+  case DISPLAY_CMD_WRITE_TEXT_BOTTOM:
+    create_bottom_label(cmd->text);
+    break;
+  case DISPLAY_CMD_DASHBOARD_CREATE:
+    apply_dashboard_create(cmd);
+    break;
+  case DISPLAY_CMD_DASHBOARD_SET:
+    apply_dashboard_set(cmd);
+    break;
+  case DISPLAY_CMD_DASHBOARD_SET_NOTE:
+    apply_dashboard_set_note(cmd);
+    break;
+  case DISPLAY_CMD_DASHBOARD_SET_BOTTOM:
+    apply_dashboard_set_bottom(cmd);
+    break;
   }
-  return ESP_FAIL;
 }
 
-esp_err_t display_manager_write_text_bottom(const char *text) {
-  if (lvgl_port_lock(0)) {
-    lv_obj_t *scr = lv_scr_act();
+// Apply everything queued so far; the next refresh draws it in one frame.
+// Call with the LVGL lock held. False between profiles, with nothing applied.
+static bool drain_cmds(void) {
+  if (!disp_handle) {
+    return false; // keep the commands for the new display
+  }
 
-    // Get screen dimensions
-    lv_coord_t screen_width = lv_disp_get_hor_res(disp_handle);
-    lv_coord_t screen_height = lv_disp_get_ver_res(disp_handle);
+  uint32_t batch = 0;
+  // A flip requested before these commands were queued goes first
+  if (atomic_exchange(&next_page_pending, false)) {
+    apply_dashboard_next_page();
+    batch++;
+  }
 
-    // Create a container for the bottom text that bypasses flex layout
-    lv_obj_t *bottom_container = lv_obj_create(scr);
-    lv_obj_remove_style_all(bottom_container);
-    lv_obj_set_size(bottom_container, screen_width,
-                    CONFIG_BOTTOM_TEXT_HEIGHT); // Fixed height for bottom text
+  unsigned head = atomic_load_explicit(&cmd_head, memory_order_acquire);
+  unsigned tail = atomic_load_explicit(&cmd_tail, memory_order_relaxed);
+  bool freed = tail != head;
+  for (; tail != head; tail++) {
+    apply_cmd(&cmd_ring[tail % DISPLAY_CMD_QUEUE_LENGTH]);
+    batch++;
+  }
+  // Hands the slots back to the producer
+  atomic_store_explicit(&cmd_tail, tail, memory_order_release);
+  if (freed) {
+    xSemaphoreGive(cmd_space);
+  }
 
-    // Position container at the very bottom using absolute coordinates
-    lv_obj_set_pos(bottom_container, 0,
-                   screen_height - CONFIG_BOTTOM_TEXT_HEIGHT);
+#ifdef CONFIG_DISPLAY_STATS
+  if (batch) {
+    taskENTER_CRITICAL(&stats_lock);
+    stats.commands += batch;
+    if (batch > stats.max_batch) {
+      stats.max_batch = batch;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+  }
+#endif
+  return true;
+}
 
-    // Create a label inside the container
-    lv_obj_t *label = lv_label_create(bottom_container);
-    lv_label_set_text(label, text);
-    lv_obj_set_width(label, screen_width);
-    lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
+// Sleeps until notified of a command. Runs at the callers' priority, so a
+// burst of calls is queued before it gets to apply them as one batch.
+static void drain_task(void *arg) {
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    bool drained = false;
+    while (!drained) {
+      if (display_lock()) {
+        drained = drain_cmds();
+        display_port_unlock();
+      }
+      if (!drained) {
+        vTaskDelay(1);
+      }
+    }
+    display_port_wake(); // draw now, not when the LVGL task next wakes
+  }
+}
 
-    // Set text color to white
-    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+static esp_err_t push_cmd(const display_cmd_t *cmd) {
+  if (!drain_task_handle) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  unsigned head = atomic_load_explicit(&cmd_head, memory_order_relaxed);
+  // Only waits when the LVGL task is a whole ring behind; a give left over
+  // from an earlier drain just means one more look at the tail
+  const TickType_t timeout = pdMS_TO_TICKS(DISPLAY_CMD_PUSH_TIMEOUT_MS);
+  TickType_t start = xTaskGetTickCount();
+  while (head - atomic_load_explicit(&cmd_tail, memory_order_acquire) ==
+         DISPLAY_CMD_QUEUE_LENGTH) {
+    TickType_t waited = xTaskGetTickCount() - start;
+    if (waited >= timeout ||
+        xSemaphoreTake(cmd_space, timeout - waited) != pdTRUE) {
+      ESP_LOGW(TAG, "Command queue full for %d ms, dropping command %d",
+               DISPLAY_CMD_PUSH_TIMEOUT_MS, (int)cmd->type);
+      return ESP_ERR_TIMEOUT;
+    }
+  }
+  cmd_ring[head % DISPLAY_CMD_QUEUE_LENGTH] = *cmd;
+  atomic_store_explicit(&cmd_head, head + 1, memory_order_release);
+  xTaskNotifyGive(drain_task_handle);
+  return ESP_OK;
+}
+
+// Runs in the esp_timer task; flips that pile up before a drain merge
+static void page_timer_cb(void *arg) {
+  atomic_store(&next_page_pending, true);
+  xTaskNotifyGive(drain_task_handle);
+}
 
-    lvgl_port_unlock();
-    return ESP_OK;
+static esp_err_t push_text(display_cmd_type_t type, const char *text,
+                           lv_color_t color, int size) {
+  if (!text) {
+    return ESP_ERR_INVALID_ARG;
   }
-  return ESP_FAIL;
+  display_cmd_t cmd = {.type = type, .color = color, .size = size};
+  strlcpy(cmd.text, text, sizeof(cmd.text));
+  return push_cmd(&cmd);
+}
+
+esp_err_t display_manager_set_bg_color(uint8_t r, uint8_t g, uint8_t b) {
+  display_cmd_t cmd = {
+      .type = DISPLAY_CMD_SET_BG_COLOR,
+      .color = lv_color_make(r, g, b),
+  };
+  return push_cmd(&cmd);
+}
+
+esp_err_t display_manager_clear(void) {
+  display_cmd_t cmd = {.type = DISPLAY_CMD_CLEAR};
+  return push_cmd(&cmd);
+}
+
+esp_err_t display_manager_write_text(const char *text) {
+  return push_text(DISPLAY_CMD_WRITE_TEXT, text, lv_color_white(), 0);
+}
+
+esp_err_t display_manager_write_text_color(const char *text, int16_t r,
+                                           int16_t g, int16_t b) {
+  return push_text(DISPLAY_CMD_WRITE_TEXT, text, lv_color_make(r, g, b), 0);
+}
+
+esp_err_t display_manager_write_text_bottom(const char *text) {
+  return push_text(DISPLAY_CMD_WRITE_TEXT_BOTTOM, text, lv_color_white(), 0);
 }
 
 esp_err_t display_manager_write_text_custom(const char *text,
                                             text_config_t config) {
-  if (lvgl_port_lock(0)) {
-    // Ensure main content container exists
-    if (!main_content_container) {
-      create_main_content_container();
-    }
+  return push_text(
+      DISPLAY_CMD_WRITE_TEXT, text,
+      lv_color_make(config.color.r, config.color.g, config.color.b),
+      config.size);
+}
 
-    lv_obj_t *label = lv_label_create(main_content_container);
-    lv_label_set_text(label, text);
+esp_err_t display_manager_dashboard_create(const char *const *names, int count,
+                                           enum text_size value_size) {
+  if (count < 0 || count > DISPLAY_DASHBOARD_MAX_ROWS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  display_cmd_t cmd = {
+      .type = DISPLAY_CMD_DASHBOARD_CREATE,
+      .size = value_size,
+      .row = count,
+      .names = names,
+  };
+  return push_cmd(&cmd);
+}
 
-    // Set text color using provided RGB values
-    lv_color_t text_color =
-        lv_color_make(config.color.r, config.color.g, config.color.b);
-    lv_obj_set_style_text_color(label, text_color, 0);
+esp_err_t display_manager_dashboard_set(int row, const char *text, uint8_t r,
+                                        uint8_t g, uint8_t b) {
+  if (row < 0 || row >= DISPLAY_DASHBOARD_MAX_ROWS || !text) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  display_cmd_t cmd = {
+      .type = DISPLAY_CMD_DASHBOARD_SET,
+      .row = row,
+      .color = lv_color_make(r, g, b),
+  };
+  strlcpy(cmd.text, text, sizeof(cmd.text));
+  return push_cmd(&cmd);
+}
 
-    // Set text size using the get_font function
-    const lv_font_t *font = get_font(config.size);
-    lv_obj_set_style_text_font(label, font, 0);
+esp_err_t display_manager_dashboard_set_state(int row, deploy_state_t state) {
+  uint32_t rgb = deploy_state_color(state);
+  return display_manager_dashboard_set(row, deploy_state_label(state),
+                                       (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF,
+                                       rgb & 0xFF);
+}
+
+esp_err_t display_manager_dashboard_set_note(int row, const char *note) {
+  if (row < 0 || row >= DISPLAY_DASHBOARD_MAX_ROWS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  display_cmd_t cmd = {.type = DISPLAY_CMD_DASHBOARD_SET_NOTE, .row = row};
+  strlcpy(cmd.text, note ? note : "", DISPLAY_DASHBOARD_NOTE_LEN);
+  return push_cmd(&cmd);
+}
+
+esp_err_t display_manager_dashboard_set_bottom(const char *text) {
+  return push_text(DISPLAY_CMD_DASHBOARD_SET_BOTTOM, text, lv_color_white(),
+                   0);
+}
+
+esp_err_t display_manager_set_profile(const display_profile_t *profile,
+                                      size_t *ram_bytes) {
+  // Objects are deleted with the old display; queued commands wait for the
+  // new one. No lock to take before the first display brings up the port.
+  if (disp_handle && display_lock()) {
+    disp_handle = NULL;
+    main_content_container = NULL;
+    dashboard_row_count = 0;
+    dashboard_bottom = NULL;
+    esp_timer_stop(page_timer);
+    display_port_unlock();
+  }
+  display_port_deinit();
+
+  size_t free_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  esp_err_t err = display_port_init(profile);
+  if (ram_bytes) {
+    *ram_bytes = free_before - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  if (display_port_lock()) {
+    disp_handle = lv_display_get_default();
+#ifdef CONFIG_DISPLAY_STATS
+    memset(&frame, 0, sizeof(frame));
+    lv_display_add_event_cb(disp_handle, display_event_cb, LV_EVENT_ALL, NULL);
+#endif
+    display_port_unlock();
+  }
+  return ESP_OK;
+}
 
-    lvgl_port_unlock();
-    return ESP_OK;
+esp_err_t display_manager_refresh_now(bool full_screen) {
+  if (!disp_handle) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
   }
-  return ESP_FAIL;
+  drain_cmds();
+  if (full_screen) {
+    lv_obj_invalidate(lv_scr_act());
+  }
+  lv_refr_now(disp_handle);
+  display_port_unlock();
+  return ESP_OK;
 }
 
 esp_err_t display_manager_init(void) {
   ESP_LOGI(TAG, "Initialize display manager");
 
-  const gpio_config_t bk_gpio_config = {
-      .mode = GPIO_MODE_OUTPUT,
-      .pin_bit_mask = 1ULL << BOARD_TFT_BL,
-  };
-  ESP_ERROR_CHECK(gpio_config(&bk_gpio_config));
-
-  spi_bus_config_t buscfg = {
-      .sclk_io_num = BOARD_SPI_SCK,
-      .mosi_io_num = BOARD_SPI_MOSI,
-      .miso_io_num = BOARD_SPI_MISO,
-      .quadwp_io_num = -1,
-      .quadhd_io_num = -1,
-      .max_transfer_sz = AMOLED_HEIGHT * 80 * sizeof(uint16_t),
-  };
-  ESP_ERROR_CHECK(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
-
-  const esp_lcd_panel_io_spi_config_t io_config = {
-      .dc_gpio_num = BOARD_TFT_DC,
-      .cs_gpio_num = BOARD_TFT_CS,
-      .pclk_hz = 27 * 1000 * 1000,
-      .lcd_cmd_bits = 8,
-      .lcd_param_bits = 8,
-      .spi_mode = 0,
-      .trans_queue_depth = 10,
-  };
-  ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)1,
-                                           &io_config, &io_handle));
+  cmd_space = xSemaphoreCreateBinary();
+  if (!cmd_space) {
+    return ESP_ERR_NO_MEM;
+  }
 
-  const esp_lcd_panel_dev_config_t panel_config = {
-      .reset_gpio_num = BOARD_TFT_RST,
-      .rgb_endian = LCD_RGB_ENDIAN_RGB,
-      .bits_per_pixel = 16,
+  const esp_timer_create_args_t page_timer_args = {
+      .callback = page_timer_cb,
+      .name = "dashboard_page",
   };
-  ESP_ERROR_CHECK(
-      esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle));
-
-  ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
-  ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
-  ESP_ERROR_CHECK(esp_lcd_panel_invert_color(panel_handle, true));
-  ESP_ERROR_CHECK(esp_lcd_panel_set_gap(panel_handle, X_OFFSET, Y_OFFSET));
-
-  ESP_ERROR_CHECK(gpio_set_level(BOARD_TFT_BL, 1));
-
-  const lvgl_port_cfg_t lvgl_cfg = {
-      .task_priority = 12,
-      .task_stack = 8192,
-      .task_affinity = -1,
-      .task_max_sleep_ms = 500,
-      .timer_period_ms = 5,
+  esp_err_t err = esp_timer_create(&page_timer_args, &page_timer);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  const display_profile_t profile = DISPLAY_PROFILE_DEFAULT;
+  err = display_manager_set_profile(&profile, NULL);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  if (xTaskCreate(drain_task, "display_cmd", DISPLAY_CMD_TASK_STACK_SIZE, NULL,
+                  DISPLAY_CMD_TASK_PRIORITY, &drain_task_handle) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+
+#if defined(CONFIG_DISPLAY_STATS) && CONFIG_DISPLAY_STATS_LOG_INTERVAL > 0
+  const esp_timer_create_args_t stats_timer_args = {
+      .callback = stats_log_cb,
+      .name = "display_stats",
   };
-  ESP_ERROR_CHECK(lvgl_port_init(&lvgl_cfg));
-
-  /* Add LCD screen */
-  const lvgl_port_display_cfg_t disp_cfg = {
-      .io_handle = io_handle,
-      .panel_handle = panel_handle,
-      .buffer_size = DISPLAY_BUFFER_SIZE,
-      .double_buffer = true,
-      .hres = AMOLED_WIDTH,
-      .vres = AMOLED_HEIGHT,
-      .monochrome = false,
-      .flags = {
-          .buff_dma = true,
-          .buff_spiram = false,
-          .full_refresh = DISPLAY_FULLRESH,
-          .swap_bytes = true,
-      }};
-  disp_handle = lvgl_port_add_disp(&disp_cfg);
-
-#if CONFIG_MIKES_WAY
-  lv_disp_set_rotation(disp_handle, LV_DISPLAY_ROTATION_180);
+  esp_timer_handle_t stats_timer;
+  ESP_ERROR_CHECK(esp_timer_create(&stats_timer_args, &stats_timer));
+  ESP_ERROR_CHECK(esp_timer_start_periodic(
+      stats_timer, (uint64_t)CONFIG_DISPLAY_STATS_LOG_INTERVAL * 1000000));
 #endif
 
-  ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
-
   return ESP_OK;
-}
\ No newline at end of file
+}
+#endif // CONFIG_DISPLAY_TILES
@@ -1,6 +1,9 @@
 #pragma once
+#include "deploy_state.h"
+#include "display_port.h"
 #include "esp_err.h"
 #include "sdkconfig.h"
+#include <stdint.h>
 
 enum text_size {
 #ifdef CONFIG_LV_FONT_MONTSERRAT_8
@@ -62,6 +65,19 @@ typedef struct {
   enum text_size size;
 } text_config_t;
 
+// display_manager calls are queued on a lock-free ring and applied in batches
+// by the display_cmd task, so they return without waiting for a render. The
+// ring has a single producer: make every call from one task. Text longer
+// than DISPLAY_CMD_TEXT_LEN - 1 is cut; a caller only blocks when
+// DISPLAY_CMD_QUEUE_LENGTH commands are still waiting, and for at most
+// DISPLAY_CMD_PUSH_TIMEOUT_MS, after which the command is dropped with
+// ESP_ERR_TIMEOUT. The length must be a power of two.
+#define DISPLAY_CMD_TEXT_LEN 48
+#define DISPLAY_CMD_QUEUE_LENGTH 64
+#define DISPLAY_CMD_PUSH_TIMEOUT_MS 1000
+#define DISPLAY_CMD_TASK_STACK_SIZE 4096
+#define DISPLAY_CMD_TASK_PRIORITY 1 // app_main's
+
 esp_err_t display_manager_init(void);
 esp_err_t display_manager_write_text(const char *text);
 esp_err_t display_manager_write_text_color(const char *text, int16_t r,
@@ -70,4 +86,103 @@ esp_err_t display_manager_write_text_bottom(const char *text);
 esp_err_t display_manager_write_text_custom(const char *text,
                                             text_config_t config);
 esp_err_t display_manager_set_bg_color(uint8_t r, uint8_t g, uint8_t b);
-esp_err_t display_manager_clear(void);
\ No newline at end of file
+esp_err_t display_manager_clear(void);
+
+// Rows the retained dashboard can hold
+#define DISPLAY_DASHBOARD_MAX_ROWS 32
+#define DISPLAY_DASHBOARD_NOTE_LEN 24
+
+/**
+ * @brief Replace the screen with a retained dashboard
+ *
+ * Creates one name/value label pair per row plus the bottom text strip, once.
+ * Later updates only touch labels whose text or color changed, so LVGL
+ * redraws just those areas. display_manager_clear() discards the dashboard.
+ * When more rows are given than fit above the bottom strip, they are shown a
+ * page at a time, flipping every CONFIG_DISPLAY_DASHBOARD_PAGE_SECONDS.
+ *
+ * @param names Row names, shown in white above each value; read when the
+ * command is applied, so they must outlive the call
+ * @param count Number of rows, at most DISPLAY_DASHBOARD_MAX_ROWS
+ * @param value_size Font size of the value labels
+ */
+esp_err_t display_manager_dashboard_create(const char *const *names, int count,
+                                           enum text_size value_size);
+
+/**
+ * @brief Set a row's value text and color, if either differs
+ */
+esp_err_t display_manager_dashboard_set(int row, const char *text, uint8_t r,
+                                        uint8_t g, uint8_t b);
+
+/**
+ * @brief Show a deployment state in a row, with its label and color
+ *
+ * With CONFIG_DISPLAY_TILES this colors and sends a 1-bit tile rendered
+ * once per value size.
+ */
+esp_err_t display_manager_dashboard_set_state(int row, deploy_state_t state);
+
+/**
+ * @brief Show a short note after a row's name, dimmed, e.g. that its value is
+ * being refreshed; the value stays as it is
+ *
+ * @param note Note text, cut to DISPLAY_DASHBOARD_NOTE_LEN - 1 characters;
+ * NULL or "" removes it
+ */
+esp_err_t display_manager_dashboard_set_note(int row, const char *note);
+
+/**
+ * @brief Set the bottom text strip of the dashboard, if it differs
+ */
+esp_err_t display_manager_dashboard_set_bottom(const char *text);
+
+typedef struct {
+  uint32_t frames;            // refreshes that flushed something
+  uint32_t invalidated_areas; // lv_obj invalidations, before merging
+  uint64_t invalidated_px;
+  uint32_t flushes; // flush callback calls, one per buffer chunk
+  uint64_t flushed_px;
+  uint64_t flushed_bytes;
+  uint32_t last_frame_bytes;
+  uint32_t max_frame_bytes;
+  uint64_t render_us;     // drawing into the buffers
+  uint64_t flush_wait_us; // LVGL task in the flush callback or waiting on it
+  uint64_t flush_us;      // flush callback start to flush ready
+  uint32_t last_frame_us;
+  uint32_t max_frame_us;
+  uint32_t commands;   // queued display_manager calls applied
+  uint32_t max_batch;  // most commands applied in one drain
+  uint32_t lock_waits; // calls that took the LVGL lock directly
+  uint64_t lock_wait_us;
+  uint32_t max_lock_wait_us;
+} display_stats_t;
+
+/**
+ * @brief Copy the render and flush counters gathered since boot
+ *
+ * @return esp_err_t ESP_ERR_NOT_SUPPORTED without CONFIG_DISPLAY_STATS or
+ * with CONFIG_DISPLAY_TILES
+ */
+esp_err_t display_manager_get_stats(display_stats_t *stats);
+
+/**
+ * @brief Rebuild the display with another buffering and SPI clock profile
+ *
+ * Discards everything on screen, like display_manager_clear().
+ *
+ * @param profile Profile to switch to
+ * @param ram_bytes If not NULL, internal RAM the new profile took
+ * @return esp_err_t ESP_ERR_NO_MEM if its draw buffers do not fit, the
+ * panel's error if it did not start, ESP_ERR_NOT_SUPPORTED with
+ * CONFIG_DISPLAY_TILES
+ */
+esp_err_t display_manager_set_profile(const display_profile_t *profile,
+                                      size_t *ram_bytes);
+
+/**
+ * @brief Render and flush pending changes now instead of on the LVGL timer
+ *
+ * @param full_screen Invalidate the whole screen first
+ */
+esp_err_t display_manager_refresh_now(bool full_screen);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hardware side of the display: panel bring-up and the LVGL task. Everything
+// in display_manager.c sits on top of LVGL and these calls only, so another
+// panel or an offscreen framebuffer can replace display_port_st7789.c. No
+// LVGL types appear here, so display_tiles.c builds without LVGL.
+// display_tiles.c skips LVGL and uses the panel calls at the end.
+
+// Longest the LVGL task sleeps with nothing to do. With DISPLAY_IDLE_SLEEP
+// there is no tick timer either, so this is its only wakeup while idle.
+#ifdef CONFIG_DISPLAY_IDLE_SLEEP
+#define DISPLAY_PORT_MAX_SLEEP_MS 60000
+#else
+#define DISPLAY_PORT_MAX_SLEEP_MS 500
+#endif
+
+// How LVGL renders and flushes to the panel
+typedef struct {
+  const char *name;
+  bool full_refresh;     // redraw the whole screen every frame
+  bool double_buffer;    // render into one buffer while the other is sent
+  uint16_t buffer_lines; // lines per draw buffer; full refresh uses all
+  uint8_t pclk_mhz;      // SPI clock
+} display_profile_t;
+
+#ifdef CONFIG_DISPLAY_FULL_REFRESH
+#define DISPLAY_PROFILE_FULL_REFRESH true
+#define DISPLAY_PROFILE_BUFFER_LINES 0
+#else
+#define DISPLAY_PROFILE_FULL_REFRESH false
+#define DISPLAY_PROFILE_BUFFER_LINES CONFIG_DISPLAY_BUFFER_LINES
+#endif
+#ifdef CONFIG_DISPLAY_DOUBLE_BUFFER
+#define DISPLAY_PROFILE_DOUBLE_BUFFER true
+#else
+#define DISPLAY_PROFILE_DOUBLE_BUFFER false
+#endif
+
+// Profile selected in menuconfig
+#define DISPLAY_PROFILE_DEFAULT                                                \
+  {                                                                            \
+      .name = "kconfig",                                                       \
+      .full_refresh = DISPLAY_PROFILE_FULL_REFRESH,                            \
+      .double_buffer = DISPLAY_PROFILE_DOUBLE_BUFFER,                          \
+      .buffer_lines = DISPLAY_PROFILE_BUFFER_LINES,                            \
+      .pclk_mhz = CONFIG_DISPLAY_SPI_CLOCK_MHZ,                                \
+  }
+
+/**
+ * @brief Bring up the panel and the LVGL task, and turn the panel on
+ *
+ * The SPI bus, backlight and LVGL task are set up on the first call only;
+ * later calls (after display_port_deinit) redo the panel and draw buffers.
+ *
+ * The LVGL display drawing to the panel is the only one, so it is LVGL's
+ * default display (lv_display_get_default()) until display_port_deinit().
+ *
+ * @param profile Buffering and SPI clock to use
+ * @return esp_err_t ESP_ERR_NO_MEM if the draw buffers did not fit, or the
+ * panel's error
+ */
+esp_err_t display_port_init(const display_profile_t *profile);
+
+/**
+ * @brief Remove the LVGL display and the panel, freeing the draw buffers
+ *
+ * Objects on the display's screens are deleted with it.
+ */
+void display_port_deinit(void);
+
+/**
+ * @brief Get the LVGL task to run its timers now instead of after its sleep
+ *
+ * Call after invalidating objects from another task.
+ */
+void display_port_wake(void);
+
+/**
+ * @brief Time the panel took to take flushed pixels, summed since the last
+ * call: from each flush callback start to its flush ready
+ *
+ * @return uint32_t Microseconds, 0 without CONFIG_DISPLAY_STATS
+ */
+uint32_t display_port_take_flush_us(void);
+
+/**
+ * @brief Take the LVGL lock, waiting as long as it takes
+ */
+bool display_port_lock(void);
+
+/**
+ * @brief Release the LVGL lock
+ */
+void display_port_unlock(void);
+
+/**
+ * @brief Bring up the panel without LVGL, for display_port_draw()
+ *
+ * @param pclk_mhz SPI clock
+ */
+esp_err_t display_port_panel_init(uint8_t pclk_mhz);
+
+/**
+ * @brief Send a block of byte-swapped RGB565 pixels to the panel
+ *
+ * Returns once the transfer is done, so the buffer can be reused. Only after
+ * display_port_panel_init().
+ */
+esp_err_t display_port_draw(int x, int y, int w, int h, const uint16_t *pixels);
@@ -0,0 +1,299 @@
+#include "config.h"
+#include "display_port.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_io_interface.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "esp_lcd_types.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_lvgl_port.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "display_port";
+
+static esp_lcd_panel_io_handle_t io_handle = NULL;
+static esp_lcd_panel_handle_t panel_handle = NULL;
+static lv_display_t *disp_handle = NULL;
+static bool port_started = false;
+static bool lvgl_started = false;
+
+#ifdef CONFIG_DISPLAY_STATS
+// Flush callback start to flush ready, summed until display_port_take_flush_us
+static portMUX_TYPE flush_time_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t flush_start_us;
+static uint32_t flush_time_us;
+
+// LVGL sends this right before calling the flush callback
+static void flush_start_cb(lv_event_t *e) {
+  taskENTER_CRITICAL(&flush_time_lock);
+  flush_start_us = esp_timer_get_time();
+  taskEXIT_CRITICAL(&flush_time_lock);
+}
+
+// esp_lvgl_port's transfer-done callback and the panel IO's own
+// registration, kept by register_timed_callbacks
+static esp_lcd_panel_io_color_trans_done_cb_t port_trans_done;
+static esp_err_t (*io_register_callbacks)(
+    esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs,
+    void *user_ctx);
+
+// Wraps esp_lvgl_port's transfer-done callback, which still signals the end
+// of the flush to LVGL
+static bool flush_done_cb(esp_lcd_panel_io_handle_t io,
+                          esp_lcd_panel_io_event_data_t *edata, void *ctx) {
+  int64_t now_us = esp_timer_get_time();
+  taskENTER_CRITICAL_ISR(&flush_time_lock);
+  flush_time_us += (uint32_t)(now_us - flush_start_us);
+  taskEXIT_CRITICAL_ISR(&flush_time_lock);
+  return port_trans_done ? port_trans_done(io, edata, ctx) : false;
+}
+
+// Stands in for the panel IO's registration while esp_lvgl_port adds the
+// display, so its callback runs behind flush_done_cb instead of being replaced
+static esp_err_t register_timed_callbacks(
+    esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs,
+    void *user_ctx) {
+  esp_lcd_panel_io_callbacks_t timed = *cbs;
+  port_trans_done = cbs->on_color_trans_done;
+  timed.on_color_trans_done = flush_done_cb;
+  return io_register_callbacks(io, &timed, user_ctx);
+}
+#endif
+
+// Bus and backlight: shared by every profile and by the tile path
+static void display_port_start(void) {
+  const gpio_config_t bk_gpio_config = {
+      .mode = GPIO_MODE_OUTPUT,
+      .pin_bit_mask = 1ULL << BOARD_TFT_BL,
+  };
+  ESP_ERROR_CHECK(gpio_config(&bk_gpio_config));
+
+  // Sized for a full-screen flush so any profile fits
+  spi_bus_config_t buscfg = {
+      .sclk_io_num = BOARD_SPI_SCK,
+      .mosi_io_num = BOARD_SPI_MOSI,
+      .miso_io_num = BOARD_SPI_MISO,
+      .quadwp_io_num = -1,
+      .quadhd_io_num = -1,
+      .max_transfer_sz = AMOLED_WIDTH * AMOLED_HEIGHT * sizeof(uint16_t),
+  };
+  ESP_ERROR_CHECK(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
+  port_started = true;
+}
+
+// Panel IO and ST7789 controller; on_done is NULL when LVGL registers its own
+static esp_err_t panel_start(uint8_t pclk_mhz,
+                             esp_lcd_panel_io_color_trans_done_cb_t on_done) {
+  if (!port_started) {
+    display_port_start();
+  }
+
+  const esp_lcd_panel_io_spi_config_t io_config = {
+      .dc_gpio_num = BOARD_TFT_DC,
+      .cs_gpio_num = BOARD_TFT_CS,
+      .pclk_hz = pclk_mhz * 1000 * 1000,
+      .lcd_cmd_bits = 8,
+      .lcd_param_bits = 8,
+      .spi_mode = 0,
+      .trans_queue_depth = 10,
+      .on_color_trans_done = on_done,
+  };
+  esp_err_t err = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)1,
+                                           &io_config, &io_handle);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Panel IO setup failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  const esp_lcd_panel_dev_config_t panel_config = {
+      .reset_gpio_num = BOARD_TFT_RST,
+      .rgb_endian = LCD_RGB_ENDIAN_RGB,
+      .bits_per_pixel = 16,
+  };
+  ESP_ERROR_CHECK(
+      esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle));
+
+  ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
+  ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
+  ESP_ERROR_CHECK(esp_lcd_panel_invert_color(panel_handle, true));
+  ESP_ERROR_CHECK(esp_lcd_panel_set_gap(panel_handle, X_OFFSET, Y_OFFSET));
+
+  ESP_ERROR_CHECK(gpio_set_level(BOARD_TFT_BL, 1));
+  return ESP_OK;
+}
+
+#ifdef CONFIG_DISPLAY_IDLE_SLEEP
+static uint32_t idle_tick_ms(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+#endif
+
+esp_err_t display_port_init(const display_profile_t *profile) {
+  ESP_LOGI(TAG,
+           "Initialize ST7789 panel (%s): %s refresh, %s buffer, %u lines, "
+           "%u MHz",
+           profile->name, profile->full_refresh ? "full" : "partial",
+           profile->double_buffer ? "double" : "single", profile->buffer_lines,
+           profile->pclk_mhz);
+
+  if (!lvgl_started) {
+    const lvgl_port_cfg_t lvgl_cfg = {
+        .task_priority = 12,
+        .task_stack = 8192,
+        .task_affinity = -1,
+        .task_max_sleep_ms = DISPLAY_PORT_MAX_SLEEP_MS,
+        .timer_period_ms = 5,
+    };
+    ESP_ERROR_CHECK(lvgl_port_init(&lvgl_cfg));
+#ifdef CONFIG_DISPLAY_IDLE_SLEEP
+    // LVGL reads the time when it needs it instead of counting 5 ms ticks.
+    // lvgl_port_stop() stops the tick timer but also disables LVGL timers,
+    // which the task still needs; it sleeps once they are all paused.
+    lvgl_port_lock(0);
+    lv_tick_set_cb(idle_tick_ms);
+    lvgl_port_unlock();
+    ESP_ERROR_CHECK(lvgl_port_stop());
+    lvgl_port_lock(0);
+    lv_timer_enable(true);
+    lvgl_port_unlock();
+#endif
+    lvgl_started = true;
+  }
+
+  esp_err_t err = panel_start(profile->pclk_mhz, NULL);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  // Full refresh needs a whole frame per buffer
+  uint32_t lines =
+      profile->full_refresh ? AMOLED_HEIGHT : profile->buffer_lines;
+
+  /* Add LCD screen */
+  const lvgl_port_display_cfg_t disp_cfg = {
+      .io_handle = io_handle,
+      .panel_handle = panel_handle,
+      .buffer_size = AMOLED_WIDTH * lines,
+      .double_buffer = profile->double_buffer,
+      .hres = AMOLED_WIDTH,
+      .vres = AMOLED_HEIGHT,
+      .monochrome = false,
+      .flags = {
+          .buff_dma = true,
+          .buff_spiram = false,
+          .full_refresh = profile->full_refresh,
+          .swap_bytes = true,
+      }};
+#ifdef CONFIG_DISPLAY_STATS
+  io_register_callbacks = io_handle->register_event_callbacks;
+  io_handle->register_event_callbacks = register_timed_callbacks;
+#endif
+  disp_handle = lvgl_port_add_disp(&disp_cfg);
+  if (!disp_handle) {
+    ESP_LOGE(TAG, "No DMA memory for %lu-line draw buffers",
+             (unsigned long)lines);
+    display_port_deinit();
+    return ESP_ERR_NO_MEM;
+  }
+
+#if CONFIG_MIKES_WAY
+  lv_disp_set_rotation(disp_handle, LV_DISPLAY_ROTATION_180);
+#endif
+
+#ifdef CONFIG_DISPLAY_STATS
+  lvgl_port_lock(0);
+  lv_display_add_event_cb(disp_handle, flush_start_cb, LV_EVENT_FLUSH_START,
+                          NULL);
+  lvgl_port_unlock();
+#endif
+
+  ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
+
+  return ESP_OK;
+}
+
+void display_port_deinit(void) {
+  if (disp_handle) {
+    lvgl_port_remove_disp(disp_handle);
+    disp_handle = NULL;
+  }
+  if (panel_handle) {
+    esp_lcd_panel_del(panel_handle);
+    panel_handle = NULL;
+  }
+  if (io_handle) {
+    esp_lcd_panel_io_del(io_handle);
+    io_handle = NULL;
+  }
+}
+
+// Tile path: wakes display_port_draw once the panel has the pixels
+static SemaphoreHandle_t draw_done = NULL;
+
+static bool draw_done_cb(esp_lcd_panel_io_handle_t io,
+                         esp_lcd_panel_io_event_data_t *edata, void *ctx) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(draw_done, &woken);
+  return woken == pdTRUE;
+}
+
+esp_err_t display_port_panel_init(uint8_t pclk_mhz) {
+  ESP_LOGI(TAG, "Initialize ST7789 panel without LVGL: %u MHz", pclk_mhz);
+
+  draw_done = xSemaphoreCreateBinary();
+  if (!draw_done) {
+    return ESP_ERR_NO_MEM;
+  }
+  esp_err_t err = panel_start(pclk_mhz, draw_done_cb);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+#if CONFIG_MIKES_WAY
+  // No LVGL to rotate in software; let the controller scan the other way
+  ESP_ERROR_CHECK(esp_lcd_panel_mirror(panel_handle, true, true));
+#endif
+
+  return esp_lcd_panel_disp_on_off(panel_handle, true);
+}
+
+esp_err_t display_port_draw(int x, int y, int w, int h,
+                            const uint16_t *pixels) {
+  if (!draw_done || !panel_handle) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err =
+      esp_lcd_panel_draw_bitmap(panel_handle, x, y, x + w, y + h, pixels);
+  if (err == ESP_OK) {
+    xSemaphoreTake(draw_done, portMAX_DELAY);
+  }
+  return err;
+}
+
+void display_port_wake(void) {
+  if (lvgl_started) {
+    lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
+  }
+}
+
+uint32_t display_port_take_flush_us(void) {
+#ifdef CONFIG_DISPLAY_STATS
+  taskENTER_CRITICAL(&flush_time_lock);
+  uint32_t us = flush_time_us;
+  flush_time_us = 0;
+  taskEXIT_CRITICAL(&flush_time_lock);
+  return us;
+#else
+  return 0;
+#endif
+}
+
+bool display_port_lock(void) { return lvgl_port_lock(0); }
+
+void display_port_unlock(void) { lvgl_port_unlock(); }
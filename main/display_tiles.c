@@ -0,0 +1,577 @@
+#include "config.h"
+#include "deploy_state.h"
+#include "display_manager.h"
+#include "display_port.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include "string.h"
+
+// display_manager.h without LVGL: text is drawn with a built-in bitmap font
+// straight into RGB565 strips, and every deployment state is rendered once
+// into a 1-bit tile that display_manager_dashboard_set_state() only has to
+// expand into the strip and send.
+#ifdef CONFIG_DISPLAY_TILES
+static const char *TAG = "display_tiles";
+
+// 5x7 ASCII glyphs from ' ' to '~', one byte per column, bit 0 at the top
+#define GLYPH_W 5
+#define GLYPH_H 7
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST '~'
+static const uint8_t glyphs[][GLYPH_W] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E},
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06},
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E},
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41},
+    {0x7F, 0x09, 0x09, 0x01, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x32},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x04, 0x02, 0x7F},
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03},
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00},
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+    {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20},
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18},
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00},
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x00, 0x7F, 0x10, 0x28, 0x44},
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C},
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C},
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00},
+    {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+_Static_assert(sizeof(glyphs) / sizeof(glyphs[0]) ==
+                   GLYPH_LAST - GLYPH_FIRST + 1,
+               "one glyph per printable ASCII character");
+
+// A character cell leaves one blank column and row after its glyph
+#define CELL_W(scale) ((GLYPH_W + 1) * (scale))
+#define CELL_H(scale) ((GLYPH_H + 1) * (scale))
+
+// Largest scale a text size maps to; also the height of the scratch strip
+#define MAX_SCALE 4
+#define STRIP_LINES CELL_H(MAX_SCALE)
+#define TEXT_SCALE 2 // write_text and dashboard names, like Montserrat 14
+#define LINE_CHARS (AMOLED_WIDTH / CELL_W(1))
+#define MAX_LINES (AMOLED_HEIGHT / CELL_H(TEXT_SCALE))
+#define BOTTOM_Y (AMOLED_HEIGHT - CONFIG_BOTTOM_TEXT_HEIGHT)
+// One bit per pixel of a strip, set where the text is drawn
+#define MASK_BYTES ((AMOLED_WIDTH * STRIP_LINES + 7) / 8)
+
+typedef struct {
+  char text[LINE_CHARS + 1];
+  uint16_t color;
+  uint8_t scale;
+} text_line_t;
+
+// Retained so a background change can repaint everything
+static text_line_t lines[MAX_LINES];
+static int line_count = 0;
+static char bottom_text[LINE_CHARS + 1];
+static uint16_t bg_color = 0;
+
+// Retained dashboard: a row shows a state tile or, with state < 0, free text
+typedef struct {
+  int16_t state;
+  text_line_t value;
+  char note[DISPLAY_DASHBOARD_NOTE_LEN];
+} dashboard_row_t;
+
+static const char *const *dashboard_names = NULL;
+static dashboard_row_t dashboard_rows[DISPLAY_DASHBOARD_MAX_ROWS];
+static int dashboard_row_count = 0;
+static int value_scale = TEXT_SCALE;
+// Rows that fit above the bottom strip are shown a page at a time
+static int dashboard_page_rows = 1;
+static int dashboard_page = 0;
+static esp_timer_handle_t page_timer = NULL;
+
+// One full-width mask per deploy_state_t, value_scale high. Colors are
+// applied when a tile is sent, so a background change does not redo them.
+static uint8_t tiles[DEPLOY_STATE_COUNT][MASK_BYTES];
+static int tiles_scale = 0;
+
+// Text drawn on demand is rendered into this mask first
+static uint8_t text_mask[MASK_BYTES];
+// Everything sent to the panel goes through this DMA strip
+static uint16_t *strip = NULL;
+static SemaphoreHandle_t tiles_lock = NULL;
+
+// Byte-swapped RGB565, the order the panel reads off the SPI bus
+static uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+  uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  return (uint16_t)((c >> 8) | (c << 8));
+}
+
+static int size_scale(enum text_size size) {
+  int scale = ((int)size + 4) / 8;
+  return scale < 1 ? 1 : scale > MAX_SCALE ? MAX_SCALE : scale;
+}
+
+// Largest scale up to the one asked for at which text fits the width
+static int fit_scale(const char *text, int scale) {
+  int len = (int)strlen(text);
+  while (scale > 1 && len * CELL_W(scale) > AMOLED_WIDTH) {
+    scale--;
+  }
+  return scale;
+}
+
+static void fill(uint16_t *buf, size_t px, uint16_t color) {
+  for (size_t i = 0; i < px; i++) {
+    buf[i] = color;
+  }
+}
+
+// Render text left-aligned and vertically centered into a full-width mask
+// of h lines; characters past the right edge are dropped
+static void render_mask(uint8_t *mask, int h, const char *text, int scale) {
+  memset(mask, 0, ((size_t)AMOLED_WIDTH * h + 7) / 8);
+  int y0 = (h - GLYPH_H * scale) / 2;
+  if (y0 < 0) {
+    y0 = 0;
+  }
+
+  for (int x0 = 0; *text && x0 + GLYPH_W * scale <= AMOLED_WIDTH;
+       text++, x0 += CELL_W(scale)) {
+    char c = *text;
+    const uint8_t *glyph =
+        glyphs[(c < GLYPH_FIRST || c > GLYPH_LAST ? '?' : c) - GLYPH_FIRST];
+    for (int col = 0; col < GLYPH_W; col++) {
+      for (int row = 0; row < GLYPH_H && y0 + row * scale < h; row++) {
+        if (!(glyph[col] & (1 << row))) {
+          continue;
+        }
+        for (int dy = 0; dy < scale && y0 + row * scale + dy < h; dy++) {
+          size_t px = (size_t)(y0 + row * scale + dy) * AMOLED_WIDTH + x0 +
+                      col * scale;
+          for (int dx = 0; dx < scale; dx++, px++) {
+            mask[px / 8] |= 1 << (px % 8);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Lines the strip can send at y, at most h
+static int clip_lines(int y, int h) {
+  if (h > STRIP_LINES) {
+    h = STRIP_LINES;
+  }
+  return y + h > AMOLED_HEIGHT ? AMOLED_HEIGHT - y : h;
+}
+
+// Expand h lines of a mask into the strip in fg on the background, and send
+static void draw_mask(int y, int h, const uint8_t *mask, uint16_t fg) {
+  size_t px = (size_t)AMOLED_WIDTH * h;
+  for (size_t i = 0; i < px; i++) {
+    strip[i] = mask[i / 8] & (1 << (i % 8)) ? fg : bg_color;
+  }
+  display_port_draw(0, y, AMOLED_WIDTH, h, strip);
+}
+
+static void draw_text(int y, int h, const char *text, int scale, uint16_t fg) {
+  if (y >= AMOLED_HEIGHT) {
+    return;
+  }
+  h = clip_lines(y, h);
+  render_mask(text_mask, h, text, scale);
+  draw_mask(y, h, text_mask, fg);
+}
+
+static void fill_rows(int y, int h, uint16_t color) {
+  fill(strip, (size_t)AMOLED_WIDTH * STRIP_LINES, color);
+  for (int end = y + h; y < end; y += STRIP_LINES) {
+    int lines_left = end - y;
+    display_port_draw(0, y, AMOLED_WIDTH,
+                      lines_left < STRIP_LINES ? lines_left : STRIP_LINES,
+                      strip);
+  }
+}
+
+#define DASHBOARD_ROW_H (CELL_H(TEXT_SCALE) + CELL_H(value_scale))
+
+static bool dashboard_row_shown(int row) {
+  return row / dashboard_page_rows == dashboard_page;
+}
+
+static int dashboard_row_y(int row) {
+  return row % dashboard_page_rows * DASHBOARD_ROW_H;
+}
+
+// Redo the tiles when the value size changes
+static void render_tiles(void) {
+  if (tiles_scale == value_scale) {
+    return;
+  }
+  for (int s = 0; s < DEPLOY_STATE_COUNT; s++) {
+    const char *label = deploy_state_label((deploy_state_t)s);
+    render_mask(tiles[s], CELL_H(value_scale), label,
+                fit_scale(label, value_scale));
+  }
+  tiles_scale = value_scale;
+}
+
+static void draw_dashboard_value(int row) {
+  if (!dashboard_row_shown(row)) {
+    return;
+  }
+  int y = dashboard_row_y(row) + CELL_H(TEXT_SCALE);
+  int h = CELL_H(value_scale);
+
+  const dashboard_row_t *entry = &dashboard_rows[row];
+  if (entry->state < 0) {
+    draw_text(y, h, entry->value.text, entry->value.scale, entry->value.color);
+    return;
+  }
+  if (y >= AMOLED_HEIGHT) {
+    return;
+  }
+  render_tiles();
+  uint32_t rgb = deploy_state_color((deploy_state_t)entry->state);
+  draw_mask(y, clip_lines(y, h), tiles[entry->state],
+            rgb565(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF));
+}
+
+// Row name, followed by its note in grey if it has one
+static void draw_dashboard_name(int row) {
+  if (!dashboard_row_shown(row)) {
+    return;
+  }
+  const char *note = dashboard_rows[row].note;
+  char text[LINE_CHARS + 1];
+  strlcpy(text, dashboard_names[row], sizeof(text));
+  if (note[0]) {
+    strlcat(text, "  ", sizeof(text));
+    strlcat(text, note, sizeof(text));
+  }
+  draw_text(dashboard_row_y(row), CELL_H(TEXT_SCALE), text,
+            fit_scale(text, TEXT_SCALE),
+            note[0] ? rgb565(128, 128, 128) : rgb565(255, 255, 255));
+}
+
+static void draw_bottom(void) {
+  draw_text(BOTTOM_Y, CONFIG_BOTTOM_TEXT_HEIGHT, bottom_text,
+            fit_scale(bottom_text, TEXT_SCALE), rgb565(255, 255, 255));
+}
+
+static void draw_dashboard_page(void) {
+  for (int i = 0; i < dashboard_row_count; i++) {
+    if (!dashboard_row_shown(i)) {
+      continue;
+    }
+    draw_dashboard_name(i);
+    if (dashboard_rows[i].state >= 0 || dashboard_rows[i].value.text[0]) {
+      draw_dashboard_value(i);
+    }
+  }
+}
+
+// Repaint the whole screen from the retained text and dashboard
+static void repaint(void) {
+  fill_rows(0, AMOLED_HEIGHT, bg_color);
+
+  int y = 0;
+  for (int i = 0; i < line_count; i++) {
+    draw_text(y, CELL_H(lines[i].scale), lines[i].text, lines[i].scale,
+              lines[i].color);
+    y += CELL_H(lines[i].scale);
+  }
+
+  draw_dashboard_page();
+
+  if (bottom_text[0]) {
+    draw_bottom();
+  }
+}
+
+static bool display_lock(void) {
+  return tiles_lock && xSemaphoreTake(tiles_lock, portMAX_DELAY) == pdTRUE;
+}
+
+static void display_unlock(void) { xSemaphoreGive(tiles_lock); }
+
+// Runs in the esp_timer task; a page is a few rows of SPI writes
+static void page_timer_cb(void *arg) {
+  if (!display_lock()) {
+    return;
+  }
+  int pages = (dashboard_row_count + dashboard_page_rows - 1) /
+              dashboard_page_rows;
+  if (pages > 1) {
+    dashboard_page = (dashboard_page + 1) % pages;
+    // The last page may be short; clear what the previous one left below it
+    fill_rows(0, dashboard_page_rows * DASHBOARD_ROW_H, bg_color);
+    draw_dashboard_page();
+  }
+  display_unlock();
+}
+
+static esp_err_t add_line(const char *text, uint16_t color, int scale) {
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+
+  int y = 0;
+  for (int i = 0; i < line_count; i++) {
+    y += CELL_H(lines[i].scale);
+  }
+  // Like an overflowing LVGL column, lines past the bottom are not shown
+  if (line_count < MAX_LINES && y < AMOLED_HEIGHT) {
+    text_line_t *line = &lines[line_count++];
+    strlcpy(line->text, text, sizeof(line->text));
+    line->color = color;
+    line->scale = fit_scale(line->text, scale);
+    draw_text(y, CELL_H(line->scale), line->text, line->scale, line->color);
+  }
+
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_write_text(const char *text) {
+  return add_line(text, rgb565(255, 255, 255), TEXT_SCALE);
+}
+
+esp_err_t display_manager_write_text_color(const char *text, int16_t r,
+                                           int16_t g, int16_t b) {
+  return add_line(text, rgb565(r, g, b), TEXT_SCALE);
+}
+
+esp_err_t display_manager_write_text_custom(const char *text,
+                                            text_config_t config) {
+  return add_line(text,
+                  rgb565(config.color.r, config.color.g, config.color.b),
+                  size_scale(config.size));
+}
+
+esp_err_t display_manager_write_text_bottom(const char *text) {
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+  strlcpy(bottom_text, text, sizeof(bottom_text));
+  draw_bottom();
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_set_bg_color(uint8_t r, uint8_t g, uint8_t b) {
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+  uint16_t color = rgb565(r, g, b);
+  if (color != bg_color) {
+    bg_color = color;
+    repaint();
+  }
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_clear(void) {
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+  line_count = 0;
+  bottom_text[0] = '\0';
+  dashboard_row_count = 0;
+  esp_timer_stop(page_timer);
+  repaint();
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_dashboard_create(const char *const *names, int count,
+                                           enum text_size value_size) {
+  if (count < 0 || count > DISPLAY_DASHBOARD_MAX_ROWS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+
+  line_count = 0;
+  bottom_text[0] = '\0';
+  dashboard_names = names;
+  value_scale = size_scale(value_size);
+  for (int i = 0; i < count; i++) {
+    // Values start empty; the first set fills them in
+    dashboard_rows[i].state = -1;
+    dashboard_rows[i].value.text[0] = '\0';
+    dashboard_rows[i].note[0] = '\0';
+  }
+  dashboard_row_count = count;
+  dashboard_page_rows = BOTTOM_Y / DASHBOARD_ROW_H;
+  if (dashboard_page_rows < 1) {
+    dashboard_page_rows = 1;
+  }
+  dashboard_page = 0;
+  esp_timer_stop(page_timer);
+  if (count > dashboard_page_rows) {
+    esp_timer_start_periodic(
+        page_timer, (uint64_t)CONFIG_DISPLAY_DASHBOARD_PAGE_SECONDS * 1000000);
+  }
+  repaint();
+
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_dashboard_set(int row, const char *text, uint8_t r,
+                                        uint8_t g, uint8_t b) {
+  if (row < 0 || row >= dashboard_row_count || !text) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+
+  dashboard_row_t *entry = &dashboard_rows[row];
+  uint16_t color = rgb565(r, g, b);
+  if (entry->state >= 0 || entry->value.color != color ||
+      strncmp(entry->value.text, text, sizeof(entry->value.text) - 1) != 0) {
+    entry->state = -1;
+    strlcpy(entry->value.text, text, sizeof(entry->value.text));
+    entry->value.color = color;
+    entry->value.scale = fit_scale(entry->value.text, value_scale);
+    draw_dashboard_value(row);
+  }
+
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_dashboard_set_state(int row, deploy_state_t state) {
+  if (row < 0 || row >= dashboard_row_count || state >= DEPLOY_STATE_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+
+  dashboard_row_t *entry = &dashboard_rows[row];
+  if (entry->state != (int16_t)state) {
+    entry->state = (int16_t)state;
+    draw_dashboard_value(row);
+  }
+
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_dashboard_set_note(int row, const char *note) {
+  if (row < 0 || row >= dashboard_row_count) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+
+  dashboard_row_t *entry = &dashboard_rows[row];
+  if (!note) {
+    note = "";
+  }
+  if (strncmp(entry->note, note, sizeof(entry->note) - 1) != 0) {
+    strlcpy(entry->note, note, sizeof(entry->note));
+    draw_dashboard_name(row);
+  }
+
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_dashboard_set_bottom(const char *text) {
+  if (!dashboard_row_count || !text) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!display_lock()) {
+    return ESP_FAIL;
+  }
+  if (strncmp(bottom_text, text, sizeof(bottom_text) - 1) != 0) {
+    strlcpy(bottom_text, text, sizeof(bottom_text));
+    draw_bottom();
+  }
+  display_unlock();
+  return ESP_OK;
+}
+
+esp_err_t display_manager_get_stats(display_stats_t *stats) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t display_manager_set_profile(const display_profile_t *profile,
+                                      size_t *ram_bytes) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t display_manager_refresh_now(bool full_screen) {
+  // Every draw has reached the panel by the time its call returns
+  if (full_screen && display_lock()) {
+    repaint();
+    display_unlock();
+  }
+  return ESP_OK;
+}
+
+esp_err_t display_manager_init(void) {
+  ESP_LOGI(TAG, "Initialize display manager (tiles, no LVGL)");
+
+  tiles_lock = xSemaphoreCreateMutex();
+  strip = heap_caps_malloc((size_t)AMOLED_WIDTH * STRIP_LINES *
+                               sizeof(uint16_t),
+                           MALLOC_CAP_DMA);
+  if (!tiles_lock || !strip) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  const esp_timer_create_args_t page_timer_args = {
+      .callback = page_timer_cb,
+      .name = "dashboard_page",
+  };
+  esp_err_t err = esp_timer_create(&page_timer_args, &page_timer);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  err = display_port_panel_init(CONFIG_DISPLAY_SPI_CLOCK_MHZ);
+  if (err != ESP_OK) {
+    return err;
+  }
+  fill_rows(0, AMOLED_HEIGHT, bg_color);
+  return ESP_OK;
+}
+#endif // CONFIG_DISPLAY_TILES
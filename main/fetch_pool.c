@@ -0,0 +1,83 @@
+#include "fetch_pool.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <stdio.h>
+
+static const char *TAG = "FETCH_POOL";
+
+typedef struct {
+  int env;
+  const char *environment;
+} fetch_job_t;
+
+static QueueHandle_t job_queue;
+static QueueHandle_t result_queue;
+static fetch_status_fn_t fetch_status;
+
+static void fetch_worker(void *arg) {
+  fetch_job_t job;
+  while (1) {
+    if (xQueueReceive(job_queue, &job, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    fetch_result_t result = {.env = job.env};
+    result.err =
+        fetch_status(job.environment, &result.state, result.deployment_id);
+    xQueueSend(result_queue, &result, portMAX_DELAY);
+  }
+}
+
+esp_err_t fetch_pool_init(fetch_status_fn_t fetch) {
+  fetch_status = fetch;
+
+  job_queue = xQueueCreate(FETCH_POOL_QUEUE_LENGTH, sizeof(fetch_job_t));
+  result_queue = xQueueCreate(FETCH_POOL_QUEUE_LENGTH, sizeof(fetch_result_t));
+  if (!job_queue || !result_queue) {
+    ESP_LOGE(TAG, "Failed to create queues");
+    return ESP_ERR_NO_MEM;
+  }
+  if (!fetch) {
+    return ESP_OK; // pushed results only
+  }
+
+  for (int i = 0; i < CONFIG_FETCH_CONCURRENCY; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "fetch%d", i);
+    if (xTaskCreate(fetch_worker, name, FETCH_POOL_STACK_SIZE, NULL,
+                    FETCH_POOL_PRIORITY, NULL) != pdPASS) {
+      ESP_LOGE(TAG, "Failed to create worker %d", i);
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  ESP_LOGI(TAG, "%d fetch workers started", CONFIG_FETCH_CONCURRENCY);
+  return ESP_OK;
+}
+
+esp_err_t fetch_pool_submit(int env, const char *environment) {
+  fetch_job_t job = {
+      .env = env,
+      .environment = environment,
+  };
+  if (xQueueSend(job_queue, &job, 0) != pdTRUE) {
+    ESP_LOGE(TAG, "Job queue full, dropping %s", environment);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t fetch_pool_post(const fetch_result_t *result) {
+  fetch_result_t pushed = *result;
+  pushed.pushed = true;
+  if (xQueueSend(result_queue, &pushed, 0) != pdTRUE) {
+    ESP_LOGW(TAG, "Result queue full, dropping pushed update");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+bool fetch_pool_wait(fetch_result_t *result, TickType_t timeout) {
+  return xQueueReceive(result_queue, result, timeout) == pdTRUE;
+}
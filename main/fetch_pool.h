@@ -0,0 +1,64 @@
+#pragma once
+
+#include "deploy_state.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+
+// Worker tasks: esp_http_client plus an mbedTLS handshake need the stack
+#define FETCH_POOL_STACK_SIZE 8192
+#define FETCH_POOL_PRIORITY 5
+// Jobs and results in flight, at most one per environment; sized for
+// POLL_MAX_ENVIRONMENTS
+#define FETCH_POOL_QUEUE_LENGTH 32
+
+// Same signature as gh_/vercel_check_deployment_status
+typedef esp_err_t (*fetch_status_fn_t)(const char *environment,
+                                       deploy_state_t *state,
+                                       char *deployment_id);
+
+typedef struct {
+  int env; // index passed to fetch_pool_submit
+  esp_err_t err;
+  deploy_state_t state;
+  char deployment_id[DEPLOY_ID_LEN]; // empty if the source did not say
+  bool pushed; // posted with fetch_pool_post, not the answer to a submit
+} fetch_result_t;
+
+/**
+ * @brief Start CONFIG_FETCH_CONCURRENCY worker tasks
+ *
+ * @param fetch Status function the workers call for each job, or NULL to
+ * create only the result queue for fetch_pool_post (no workers)
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if tasks or queues could
+ * not be created
+ */
+esp_err_t fetch_pool_init(fetch_status_fn_t fetch);
+
+/**
+ * @brief Queue an environment for fetching on the next free worker
+ *
+ * @param env Caller's environment index, returned with the result
+ * @param environment Environment name, must outlive the fetch
+ */
+esp_err_t fetch_pool_submit(int env, const char *environment);
+
+/**
+ * @brief Hand a status learned outside the pool (e.g. a webhook) to the
+ * consumer of fetch_pool_wait
+ *
+ * The result is marked pushed. Safe to call from any task.
+ */
+esp_err_t fetch_pool_post(const fetch_result_t *result);
+
+/**
+ * @brief Wait for the next result
+ *
+ * Results arrive in completion order, not submission order, with pushed
+ * results interleaved.
+ *
+ * @param timeout Ticks to wait, portMAX_DELAY to block
+ * @return true if a result was received
+ */
+bool fetch_pool_wait(fetch_result_t *result, TickType_t timeout);
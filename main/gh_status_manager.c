@@ -1,26 +1,29 @@
 #include "gh_status_manager.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "http_conn_manager.h"
+#include "json_scanner.h"
+#include "scan_keys.h"
 #include "string.h"
+#include <stdbool.h>
 #include <stdio.h>
+#include <strings.h>
 
 static const char *TAG = "GH_STATUS";
 
-// Static buffers to avoid dynamic allocation
-static char response_buffer[MAX_RESPONSE_SIZE];
-static char url_buffer[MAX_URL_SIZE];
-
-// Helper function to get pre-built URL for environment
-static const char *get_deployments_url(const char *environment) {
-  for (int i = 0; environment_urls[i].name != NULL; i++) {
-    if (strcmp(environment, environment_urls[i].name) == 0) {
-      return environment_urls[i].url;
-    }
-  }
-  return NULL; // Unknown environment
-}
+// Per-request parse state, passed to the event handler as user data
+typedef struct {
+  json_scanner_t scanner;
+  char etag[MAX_ETAG_SIZE]; // captured from the response headers
+} gh_response_t;
 
 static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
+  gh_response_t *response = (gh_response_t *)evt->user_data;
+
   switch (evt->event_id) {
   case HTTP_EVENT_ERROR:
     ESP_LOGE(TAG, "HTTP error");
@@ -32,20 +35,13 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
     ESP_LOGI(TAG, "HTTP headers sent");
     break;
   case HTTP_EVENT_ON_HEADER:
-    break;
-  case HTTP_EVENT_ON_DATA:
-    if (!esp_http_client_is_chunked_response(evt->client)) {
-      size_t data_len = evt->data_len;
-      size_t buffer_len = strlen(response_buffer);
-
-      // Prevent buffer overflow
-      if (buffer_len + data_len >= MAX_RESPONSE_SIZE) {
-        data_len = MAX_RESPONSE_SIZE - buffer_len - 1;
-      }
-
-      if (data_len > 0) {
-        strncat(response_buffer, evt->data, data_len);
-      }
+    if (strcasecmp(evt->header_key, "ETag") == 0 &&
+        strlcpy(response->etag, evt->header_value, sizeof(response->etag)) >=
+            sizeof(response->etag)) {
+      // A cut ETag never matches; skip the cache rather than send it
+      ESP_LOGW(TAG, "ETag longer than %d characters, not cached",
+               MAX_ETAG_SIZE - 1);
+      response->etag[0] = '\0';
     }
     break;
   case HTTP_EVENT_ON_FINISH:
@@ -60,201 +56,406 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
   return ESP_OK;
 }
 
-static esp_err_t parse_json_field(const char *json, const char *field_name,
-                                  char *value, size_t value_size) {
-  if (!json || !field_name || !value || value_size == 0) {
-    return ESP_ERR_INVALID_ARG;
+#define GH_TARGET_COUNT                                                        \
+  ((int)(sizeof(github_targets) / sizeof(github_targets[0])) - 1)
+
+static int get_target_index(const char *name) {
+  for (int i = 0; github_targets[i].name != NULL; i++) {
+    if (strcmp(name, github_targets[i].name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int gh_find_target(const char *repo, const char *environment) {
+  for (int i = 0; github_targets[i].name != NULL; i++) {
+    if (strcmp(repo, github_targets[i].repo) == 0 &&
+        strcmp(environment, github_targets[i].environment) == 0) {
+      return i;
+    }
   }
+  return -1;
+}
 
-  char search_pattern[64];
-  snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", field_name);
+#ifdef CONFIG_GITHUB_USE_GRAPHQL
+// Query string generated from the GITHUB_TARGETS table at build time
+#define X(name, owner, repo, env)                                              \
+  GITHUB_GRAPHQL_TARGET_FIELD(name, owner, repo, env)
+static const char graphql_query[] = GITHUB_GRAPHQL_QUERY(GITHUB_TARGETS);
+#undef X
+
+// Results of the last batch query; each entry is handed out once, and the
+// next lookup of a consumed or aged-out target triggers a new query
+static struct {
+  deploy_state_t state;
+  char deployment_id[DEPLOY_ID_LEN];
+  bool fresh;
+} graphql_results[GH_TARGET_COUNT];
+static int64_t graphql_fetched_ms;
+// Held across the freshness check and refetch so that workers polling
+// different targets share one query instead of racing to send their own
+static SemaphoreHandle_t graphql_lock;
+
+// One alias key per target, then the state and the deployment ID
+#define X GH_GRAPHQL_ALIAS_KEY
+static const json_scan_key_t graphql_keys[] = {GH_GRAPHQL_KEYS};
+#undef X
+#define GRAPHQL_STATE_KEY GH_TARGET_COUNT
+#define GRAPHQL_ID_KEY (GH_TARGET_COUNT + 1)
+
+static bool graphql_scan_cb(void *ctx, int key_index, const char *value) {
+  int *current_env = (int *)ctx;
+
+  if (key_index < GRAPHQL_STATE_KEY) {
+    *current_env = key_index; // entering this target's alias
+  } else if (*current_env >= 0 && value) {
+    if (key_index == GRAPHQL_ID_KEY) {
+      strlcpy(graphql_results[*current_env].deployment_id, value,
+              sizeof(graphql_results[*current_env].deployment_id));
+    } else {
+      graphql_results[*current_env].state = deploy_state_parse(value);
+    }
+  }
+  return true;
+}
 
-  const char *field_start = strstr(json, search_pattern);
-  if (!field_start) {
-    return ESP_ERR_NOT_FOUND;
+static esp_err_t graphql_fetch_all(void) {
+  for (int i = 0; i < GH_TARGET_COUNT; i++) {
+    // No deployment or no status yet stays unknown
+    graphql_results[i].state = DEPLOY_STATE_UNKNOWN;
+    graphql_results[i].deployment_id[0] = '\0';
   }
 
-  const char *value_start = strchr(field_start, ':');
-  if (!value_start) {
-    return ESP_ERR_NOT_FOUND;
+  int current_env = -1;
+  gh_response_t response = {0};
+  json_scanner_init(&response.scanner, graphql_keys,
+                    sizeof(graphql_keys) / sizeof(graphql_keys[0]), 0,
+                    graphql_scan_cb, &current_env);
+
+  http_conn_request_t request = {
+      .url = GITHUB_GRAPHQL_URL,
+      .method = HTTP_METHOD_POST,
+      .post_data = graphql_query,
+      .scanner = &response.scanner,
+      .event_handler = http_event_handler,
+      .user_data = &response,
+  };
+
+  int status_code = 0;
+  esp_err_t err = http_conn_perform(HTTP_HOST_GITHUB, &request, &status_code);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "GraphQL request failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  ESP_LOGI(TAG, "GraphQL HTTP Status: %d", status_code);
+  if (status_code != 200) {
+    ESP_LOGE(TAG, "GraphQL request failed with status %d", status_code);
+    return ESP_FAIL;
+  }
+  if (response.scanner.status == JSON_SCAN_ERROR) {
+    ESP_LOGE(TAG, "Malformed GraphQL response");
+    return ESP_ERR_INVALID_RESPONSE;
   }
 
-  value_start++; // Skip ':'
-  while (*value_start == ' ' || *value_start == '\t') {
-    value_start++; // Skip whitespace
+  graphql_fetched_ms = esp_timer_get_time() / 1000;
+  for (int i = 0; i < GH_TARGET_COUNT; i++) {
+    graphql_results[i].fresh = true;
+    ESP_LOGI(TAG, "GraphQL %s: %s", github_targets[i].name,
+             deploy_state_label(graphql_results[i].state));
   }
+  return ESP_OK;
+}
 
-  const char *value_end;
-  if (*value_start == '"') {
-    // String value
-    value_start++; // Skip opening quote
-    value_end = strchr(value_start, '"');
-    if (!value_end) {
-      return ESP_ERR_INVALID_RESPONSE;
-    }
-  } else {
-    // Numeric value
-    value_end = value_start;
-    while ((*value_end >= '0' && *value_end <= '9') || *value_end == '.') {
-      value_end++;
-    }
-    // Don't include trailing comma, bracket, or whitespace in the value
+esp_err_t gh_check_deployment_status(const char *environment,
+                                     deploy_state_t *state,
+                                     char *deployment_id) {
+  if (!environment || !state || !deployment_id) {
+    return ESP_ERR_INVALID_ARG;
   }
 
-  size_t value_len = value_end - value_start;
-  if (value_len >= value_size) {
-    value_len = value_size - 1;
+  deployment_id[0] = '\0';
+  int index = get_target_index(environment);
+  if (index < 0) {
+    ESP_LOGE(TAG, "Unknown target: %s", environment);
+    *state = DEPLOY_STATE_UNKNOWN;
+    return ESP_ERR_INVALID_ARG;
   }
 
-  strncpy(value, value_start, value_len);
-  value[value_len] = '\0';
+  xSemaphoreTake(graphql_lock, portMAX_DELAY);
+  int64_t age_ms = esp_timer_get_time() / 1000 - graphql_fetched_ms;
+  if (!graphql_results[index].fresh ||
+      age_ms > GITHUB_GRAPHQL_RESULT_MAX_AGE_MS) {
+    esp_err_t err = graphql_fetch_all();
+    if (err != ESP_OK) {
+      xSemaphoreGive(graphql_lock);
+      *state = DEPLOY_STATE_UNKNOWN;
+      return err;
+    }
+  }
 
+  *state = graphql_results[index].state;
+  strlcpy(deployment_id, graphql_results[index].deployment_id, DEPLOY_ID_LEN);
+  graphql_results[index].fresh = false;
+  xSemaphoreGive(graphql_lock);
   return ESP_OK;
 }
 
-static esp_err_t get_deployment_id(const char *environment, char *deployment_id,
-                                   size_t id_size) {
-  if (!environment || !deployment_id || id_size == 0) {
-    return ESP_ERR_INVALID_ARG;
+esp_err_t gh_status_manager_init(void) {
+  graphql_lock = xSemaphoreCreateMutex();
+  return graphql_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+#else // REST: one deployments + one statuses request per target
+
+// Last ETag and parsed value per URL, keyed by URL hash
+typedef struct {
+  uint32_t url_hash;
+  char etag[MAX_ETAG_SIZE];
+  char value[32];
+  uint32_t last_used; // etag_cache_clock at the last lookup or store
+} etag_cache_entry_t;
+
+static etag_cache_entry_t etag_cache[ETAG_CACHE_SIZE];
+static uint32_t etag_cache_clock = 0;
+// Shared by all fetch workers; held only while copying entries
+static portMUX_TYPE etag_cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t hash_url(const char *url) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  while (*url) {
+    hash ^= (uint8_t)*url++;
+    hash *= 16777619u;
   }
+  return hash;
+}
 
-  // Clear response buffer
-  memset(response_buffer, 0, sizeof(response_buffer));
+// Call with etag_cache_lock held; marks the entry as just used
+static etag_cache_entry_t *etag_cache_find(uint32_t url_hash) {
+  for (int i = 0; i < ETAG_CACHE_SIZE; i++) {
+    if (etag_cache[i].url_hash == url_hash && etag_cache[i].etag[0]) {
+      etag_cache[i].last_used = ++etag_cache_clock;
+      return &etag_cache[i];
+    }
+  }
+  return NULL;
+}
 
-  // Get pre-built URL for environment
-  const char *url = get_deployments_url(environment);
-  if (!url) {
-    ESP_LOGE(TAG, "Unknown environment: %s", environment);
-    return ESP_ERR_INVALID_ARG;
+// Call with etag_cache_lock held. An empty slot, else the least recently
+// used: the statuses URL of a superseded deployment goes before a
+// deployments URL that is looked up every poll.
+static etag_cache_entry_t *etag_cache_victim(void) {
+  etag_cache_entry_t *victim = &etag_cache[0];
+  for (int i = 0; i < ETAG_CACHE_SIZE; i++) {
+    if (!etag_cache[i].etag[0]) {
+      return &etag_cache[i];
+    }
+    // Wrap-safe: age since the last use
+    if (etag_cache_clock - etag_cache[i].last_used >
+        etag_cache_clock - victim->last_used) {
+      victim = &etag_cache[i];
+    }
   }
+  return victim;
+}
 
-  esp_http_client_config_t config = {
+// Copy out the cached ETag and value for a URL, false if there is none
+static bool etag_cache_lookup(uint32_t url_hash, char *etag, char *value) {
+  taskENTER_CRITICAL(&etag_cache_lock);
+  etag_cache_entry_t *entry = etag_cache_find(url_hash);
+  if (entry) {
+    memcpy(etag, entry->etag, sizeof(entry->etag));
+    memcpy(value, entry->value, sizeof(entry->value));
+  }
+  taskEXIT_CRITICAL(&etag_cache_lock);
+  return entry != NULL;
+}
+
+static void etag_cache_store(uint32_t url_hash, const char *etag,
+                             const char *value) {
+  taskENTER_CRITICAL(&etag_cache_lock);
+  etag_cache_entry_t *entry = etag_cache_find(url_hash);
+  if (!entry) {
+    entry = etag_cache_victim();
+    entry->last_used = ++etag_cache_clock;
+  }
+  entry->url_hash = url_hash;
+  strlcpy(entry->etag, etag, sizeof(entry->etag));
+  strlcpy(entry->value, value, sizeof(entry->value));
+  taskEXIT_CRITICAL(&etag_cache_lock);
+}
+
+// Latest deployment per target and its last status. A deployment that
+// reached a terminal state never changes again, so while the deployments
+// lookup returns the same ID its statuses request can be skipped.
+static struct {
+  char deployment_id[DEPLOY_ID_LEN];
+  deploy_state_t state;
+} deployment_cache[GH_TARGET_COUNT];
+
+typedef struct {
+  char *value;
+  size_t value_size;
+  bool found;
+} field_result_t;
+
+static bool field_scan_cb(void *ctx, int key_index, const char *value) {
+  field_result_t *result = (field_result_t *)ctx;
+  if (!value) {
+    return true; // not a scalar, keep looking
+  }
+  strlcpy(result->value, value, result->value_size);
+  result->found = true;
+  return false; // only the newest entry is needed
+}
+
+// GET a GitHub URL and extract the newest entry's key, answering from the
+// ETag cache when the server reports 304 Not Modified
+static esp_err_t fetch_json_field(const char *url, const json_scan_key_t *key,
+                                  char *value, size_t value_size) {
+  uint32_t url_hash = hash_url(url);
+  char cached_etag[MAX_ETAG_SIZE];
+  char cached_value[32];
+  bool cached = etag_cache_lookup(url_hash, cached_etag, cached_value);
+
+  field_result_t result = {
+      .value = value,
+      .value_size = value_size,
+  };
+  gh_response_t response = {0};
+  json_scanner_init(&response.scanner, key, 1, 0, field_scan_cb, &result);
+
+  http_conn_request_t request = {
       .url = url,
-      .method = HTTP_METHOD_GET,
+      .scanner = &response.scanner,
       .event_handler = http_event_handler,
-      .buffer_size = MAX_RESPONSE_SIZE,
-      .buffer_size_tx = MAX_RESPONSE_SIZE,
+      .user_data = &response,
+      .if_none_match = cached ? cached_etag : NULL,
   };
 
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  if (!client) {
-    ESP_LOGE(TAG, "Failed to initialize HTTP client");
-    return ESP_ERR_NO_MEM;
+  int status_code = 0;
+  esp_err_t err = http_conn_perform(HTTP_HOST_GITHUB, &request, &status_code);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  ESP_LOGI(TAG, "HTTP Status: %d", status_code);
+
+  if (status_code == 304 && cached) {
+    strlcpy(value, cached_value, value_size);
+    ESP_LOGI(TAG, "Not modified, cached %s: %s", key->name, value);
+    return ESP_OK;
   }
 
-  // Set GitHub token header
-  esp_http_client_set_header(client, "Authorization",
-                             "token " CONFIG_GITHUB_AUTH_TOKEN);
-  esp_http_client_set_header(client, "User-Agent", "ESP32-GitHub-Status");
-  esp_http_client_set_header(client, "Accept",
-                             "application/vnd.github.v3+json");
+  if (status_code != 200) {
+    ESP_LOGE(TAG, "HTTP request failed with status %d", status_code);
+    return ESP_FAIL;
+  }
 
-  esp_err_t err = esp_http_client_perform(client);
-  if (err == ESP_OK) {
-    int status_code = esp_http_client_get_status_code(client);
-    ESP_LOGI(TAG, "HTTP Status: %d", status_code);
-
-    if (status_code == 200) {
-      err = parse_json_field(response_buffer, "id", deployment_id, id_size);
-      if (err == ESP_OK) {
-        ESP_LOGI(TAG, "Found deployment ID: %s", deployment_id);
-      } else {
-        ESP_LOGE(TAG, "Failed to parse deployment ID");
-      }
-    } else {
-      ESP_LOGE(TAG, "HTTP request failed with status %d", status_code);
-      err = ESP_FAIL;
-    }
-  } else {
-    ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+  if (!result.found) {
+    return response.scanner.status == JSON_SCAN_ERROR
+               ? ESP_ERR_INVALID_RESPONSE
+               : ESP_ERR_NOT_FOUND;
   }
 
-  esp_http_client_cleanup(client);
-  return err;
+  if (response.etag[0]) {
+    etag_cache_store(url_hash, response.etag, value);
+  }
+  return ESP_OK;
 }
 
-static esp_err_t get_deployment_status(const char *deployment_id, char *status,
-                                       size_t status_size) {
-  if (!deployment_id || !status || status_size == 0) {
+static esp_err_t get_deployment_id(int index, char *deployment_id,
+                                   size_t id_size) {
+  if (!deployment_id || id_size == 0) {
     return ESP_ERR_INVALID_ARG;
   }
 
-  // Clear response buffer
-  memset(response_buffer, 0, sizeof(response_buffer));
-
-  // Build URL for statuses endpoint
-  snprintf(url_buffer, sizeof(url_buffer), "%s/%s/statuses?per_page=1",
-           GITHUB_STATUSES_BASE, deployment_id);
+  // Pre-built URL for the target
+  esp_err_t err = fetch_json_field(github_targets[index].url, &gh_rest_id_key,
+                                   deployment_id, id_size);
+  if (err == ESP_OK) {
+    ESP_LOGI(TAG, "Found deployment ID: %s", deployment_id);
+  } else {
+    ESP_LOGE(TAG, "Failed to parse deployment ID");
+  }
 
-  esp_http_client_config_t config = {
-      .url = url_buffer,
-      .method = HTTP_METHOD_GET,
-      .event_handler = http_event_handler,
-      .buffer_size = MAX_RESPONSE_SIZE,
-      .buffer_size_tx = MAX_RESPONSE_SIZE,
-  };
+  return err;
+}
 
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  if (!client) {
-    ESP_LOGE(TAG, "Failed to initialize HTTP client");
-    return ESP_ERR_NO_MEM;
+static esp_err_t get_deployment_status(int index, const char *deployment_id,
+                                       deploy_state_t *state) {
+  if (!deployment_id || !state) {
+    return ESP_ERR_INVALID_ARG;
   }
 
-  // Set GitHub token header
-  esp_http_client_set_header(client, "Authorization",
-                             "token " CONFIG_GITHUB_AUTH_TOKEN);
-  esp_http_client_set_header(client, "User-Agent", "ESP32-GitHub-Status");
-  esp_http_client_set_header(client, "Accept",
-                             "application/vnd.github.v3+json");
+  // Build URL for statuses endpoint; on the stack, workers run concurrently
+  char url[MAX_URL_SIZE];
+  snprintf(url, sizeof(url), "%s/%s/statuses?per_page=1",
+           github_targets[index].deployments_base, deployment_id);
 
-  esp_err_t err = esp_http_client_perform(client);
+  char raw_state[32];
+  esp_err_t err =
+      fetch_json_field(url, &gh_rest_state_key, raw_state, sizeof(raw_state));
   if (err == ESP_OK) {
-    int status_code = esp_http_client_get_status_code(client);
-    ESP_LOGI(TAG, "HTTP Status: %d", status_code);
-
-    if (status_code == 200) {
-      err = parse_json_field(response_buffer, "state", status, status_size);
-      if (err == ESP_OK) {
-        ESP_LOGI(TAG, "Found deployment status: %s", status);
-      } else {
-        ESP_LOGE(TAG, "Failed to parse deployment status");
-      }
-    } else {
-      ESP_LOGE(TAG, "HTTP request failed with status %d", status_code);
-      err = ESP_FAIL;
-    }
+    *state = deploy_state_parse(raw_state);
+    ESP_LOGI(TAG, "Found deployment status: %s", raw_state);
   } else {
-    ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+    ESP_LOGE(TAG, "Failed to parse deployment status");
   }
 
-  esp_http_client_cleanup(client);
   return err;
 }
 
-esp_err_t gh_check_deployment_status(const char *environment, char *status,
-                                     size_t status_size) {
-  if (!environment || !status || status_size == 0) {
+esp_err_t gh_check_deployment_status(const char *environment,
+                                     deploy_state_t *state,
+                                     char *deployment_id) {
+  if (!environment || !state || !deployment_id) {
     return ESP_ERR_INVALID_ARG;
   }
 
-  char deployment_id[32];
+  deployment_id[0] = '\0';
+  int index = get_target_index(environment);
+  if (index < 0) {
+    ESP_LOGE(TAG, "Unknown target: %s", environment);
+    *state = DEPLOY_STATE_UNKNOWN;
+    return ESP_ERR_INVALID_ARG;
+  }
 
   // Step 1: Get deployment ID
-  esp_err_t err =
-      get_deployment_id(environment, deployment_id, sizeof(deployment_id));
+  esp_err_t err = get_deployment_id(index, deployment_id, DEPLOY_ID_LEN);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "Failed to get deployment ID: %s", esp_err_to_name(err));
-    snprintf(status, status_size, "unknown");
+    deployment_id[0] = '\0';
+    *state = DEPLOY_STATE_UNKNOWN;
     return err;
   }
 
+  // Same deployment, already settled: nothing left to ask
+  if (deploy_state_is_terminal(deployment_cache[index].state) &&
+      strcmp(deployment_cache[index].deployment_id, deployment_id) == 0) {
+    *state = deployment_cache[index].state;
+    ESP_LOGI(TAG, "Deployment %s unchanged and settled: %s", deployment_id,
+             deploy_state_label(*state));
+    return ESP_OK;
+  }
+
   // Step 2: Get deployment status
-  err = get_deployment_status(deployment_id, status, status_size);
+  err = get_deployment_status(index, deployment_id, state);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "Failed to get deployment status: %s", esp_err_to_name(err));
-    snprintf(status, status_size, "unknown");
+    *state = DEPLOY_STATE_UNKNOWN;
     return err;
   }
 
+  strlcpy(deployment_cache[index].deployment_id, deployment_id,
+          sizeof(deployment_cache[index].deployment_id));
+  deployment_cache[index].state = *state;
   return ESP_OK;
 }
+
+esp_err_t gh_status_manager_init(void) {
+  return ESP_OK; // REST lookups share no state beyond the ETag cache lock
+}
+
+#endif // CONFIG_GITHUB_USE_GRAPHQL
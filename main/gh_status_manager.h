@@ -1,38 +1,80 @@
 #pragma once
 
+#include "deploy_state.h"
 #include "esp_err.h"
 #include "sdkconfig.h"
 
 // GitHub API endpoints - build-time optimized
 #define GITHUB_API_BASE "https://api.github.com"
-#define GITHUB_DEPLOYMENTS_BASE                                                \
-  "https://api.github.com/repos/" CONFIG_GITHUB_USERNAME                       \
-  "/" CONFIG_GITHUB_REPO "/deployments"
-#define GITHUB_STATUSES_BASE                                                   \
-  "https://api.github.com/repos/" CONFIG_GITHUB_USERNAME                       \
-  "/" CONFIG_GITHUB_REPO "/deployments"
-
-// Pre-built URLs for each environment
-#define ENVIRONMENTS                                                           \
-  X(production)                                                                \
-  X(staging)                                                                   \
-  X(preview)
-
-// Generate environment URL lookup table at build time
-#define X(env)                                                                 \
-  {#env, GITHUB_DEPLOYMENTS_BASE "?environment=" #env "&per_page=1"},
+#define GITHUB_DEPLOYMENTS_BASE(owner, repo)                                   \
+  GITHUB_API_BASE "/repos/" owner "/" repo "/deployments"
+#define GITHUB_GRAPHQL_URL GITHUB_API_BASE "/graphql"
+
+// Monitored targets: X(name, owner, repository, environment). name is the
+// panel label and GraphQL alias, so it must be a unique identifier; add rows
+// to watch environments of other repositories.
+#define GITHUB_TARGETS                                                         \
+  X(production, CONFIG_GITHUB_USERNAME, CONFIG_GITHUB_REPO, "production")      \
+  X(staging, CONFIG_GITHUB_USERNAME, CONFIG_GITHUB_REPO, "staging")            \
+  X(preview, CONFIG_GITHUB_USERNAME, CONFIG_GITHUB_REPO, "preview")
+
+// Generate target lookup table at build time
+#define X(name, owner, repo, env)                                              \
+  {#name, owner "/" repo, env, GITHUB_DEPLOYMENTS_BASE(owner, repo),           \
+   GITHUB_DEPLOYMENTS_BASE(owner, repo) "?environment=" env "&per_page=1"},
 static const struct {
   const char *name;
-  const char *url;
-} environment_urls[] = {
-    ENVIRONMENTS{NULL, NULL} // Sentinel
+  const char *repo; // owner/repository, as in webhook payloads
+  const char *environment;
+  const char *deployments_base;
+  const char *url; // latest deployment of this environment
+} github_targets[] = {
+    GITHUB_TARGETS{NULL, NULL, NULL, NULL, NULL} // Sentinel
 };
 #undef X
 
-// Response buffer size (keep under 1KB total)
-#define MAX_RESPONSE_SIZE 512
+// GraphQL mode: one aliased repository field per target, so a single POST
+// returns the latest deployment and its latest status for all of them.
+// Expand with X defined as GITHUB_GRAPHQL_TARGET_FIELD.
+#define GITHUB_GRAPHQL_TARGET_FIELD(name, owner, repo, env)                    \
+  #name ":repository(owner:\\\"" owner "\\\",name:\\\"" repo "\\\")"           \
+        "{deployments(environments:[\\\"" env "\\\"],first:1,"                 \
+        "orderBy:{field:CREATED_AT,direction:DESC})"                           \
+        "{nodes{databaseId latestStatus{state}}}} "
+#define GITHUB_GRAPHQL_QUERY(fields) "{\"query\":\"query{" fields "}\"}"
+
 #define MAX_URL_SIZE 256
 
+// GraphQL results older than this are refetched rather than handed out, since
+// environments are polled on independent schedules
+#define GITHUB_GRAPHQL_RESULT_MAX_AGE_MS 5000
+
+// Conditional request (If-None-Match) cache - deployments + statuses URLs,
+// one of each per target
+// GitHub sends weak SHA-256 ETags, W/"<64 hex digits>": 68 characters
+#define MAX_ETAG_SIZE 96
+#define ETAG_CACHE_SIZE                                                        \
+  ((int)(2 * (sizeof(github_targets) / sizeof(github_targets[0]) - 1)))
+
 // Function declarations
-esp_err_t gh_check_deployment_status(const char *environment, char *status,
-                                     size_t status_size);
+esp_err_t gh_status_manager_init(void);
+
+/**
+ * @brief Look up the latest deployment of a target and its state
+ *
+ * @param environment Target name from GITHUB_TARGETS
+ * @param state Latest deployment's state, DEPLOY_STATE_UNKNOWN on error
+ * @param deployment_id DEPLOY_ID_LEN buffer for its ID, empty if unknown
+ */
+esp_err_t gh_check_deployment_status(const char *environment,
+                                     deploy_state_t *state,
+                                     char *deployment_id);
+
+/**
+ * @brief Find the target watching an environment of a repository
+ *
+ * @param repo owner/repository
+ * @param environment Deployment environment
+ * @return int Index into GITHUB_TARGETS, -1 if not watched
+ */
+int gh_find_target(const char *repo, const char *environment);
@@ -0,0 +1,340 @@
+#include "http_conn_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "poll_scheduler.h"
+#include "string.h"
+#include <stdbool.h>
+
+static const char *TAG = "HTTP_CONN";
+
+typedef struct {
+  const char *name;
+  const char *base_url;
+  const char *authorization;
+  const char *user_agent;
+  const char *accept;
+  int buffer_size;
+} http_host_info_t;
+
+// Generate host table at build time
+#define X(name, base, auth, ua, accept, buf) {#name, base, auth, ua, accept, buf},
+static const http_host_info_t host_info[HTTP_HOST_COUNT] = {HTTP_CONN_HOSTS};
+#undef X
+
+typedef struct {
+  esp_http_client_handle_t client;
+  http_host_t host;
+  const http_conn_request_t *request; // request currently in flight
+  bool busy;                          // claimed by a caller, see pool_lock
+  bool connected;
+  bool data_seen;
+  bool has_session;         // a TLS session ticket is cached on the client
+  int64_t connect_start_us; // start of the current perform attempt
+  http_conn_stats_t cycle;
+  http_conn_stats_t total;
+} http_conn_slot_t;
+
+static http_conn_slot_t slots[HTTP_HOST_COUNT][HTTP_CONN_POOL_SIZE];
+
+// Guards the busy flags; everything else in a slot belongs to its claimer
+static portMUX_TYPE pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Claim an idle slot, preferring one whose connection is still open
+static http_conn_slot_t *acquire_slot(http_host_t host) {
+  http_conn_slot_t *slot = NULL;
+
+  taskENTER_CRITICAL(&pool_lock);
+  for (int i = 0; i < HTTP_CONN_POOL_SIZE; i++) {
+    http_conn_slot_t *candidate = &slots[host][i];
+    if (candidate->busy) {
+      continue;
+    }
+    if (!slot || (candidate->connected && !slot->connected)) {
+      slot = candidate;
+    }
+  }
+  if (slot) {
+    slot->busy = true;
+    slot->host = host;
+  }
+  taskEXIT_CRITICAL(&pool_lock);
+  return slot;
+}
+
+static void release_slot(http_conn_slot_t *slot) {
+  taskENTER_CRITICAL(&pool_lock);
+  slot->busy = false;
+  taskEXIT_CRITICAL(&pool_lock);
+}
+
+static void record_handshake(http_conn_slot_t *slot) {
+  uint32_t elapsed_ms =
+      (uint32_t)((esp_timer_get_time() - slot->connect_start_us) / 1000);
+
+  if (slot->has_session) {
+    slot->cycle.session_resumed++;
+    slot->cycle.resumed_ms += elapsed_ms;
+    slot->total.session_resumed++;
+    slot->total.resumed_ms += elapsed_ms;
+  } else {
+    slot->cycle.session_full++;
+    slot->cycle.full_ms += elapsed_ms;
+    slot->total.session_full++;
+    slot->total.full_ms += elapsed_ms;
+  }
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+  // The transport keeps the ticket from this handshake for the next connect
+  slot->has_session = true;
+#endif
+}
+
+// Single event handler for every pooled client: counts handshakes, then
+// forwards to the handler of the request currently in flight
+static esp_err_t http_conn_event_handler(esp_http_client_event_t *evt) {
+  http_conn_slot_t *slot = (http_conn_slot_t *)evt->user_data;
+
+  switch (evt->event_id) {
+  case HTTP_EVENT_ON_CONNECTED:
+    slot->connected = true;
+    slot->cycle.handshakes++;
+    slot->total.handshakes++;
+    record_handshake(slot);
+    break;
+  case HTTP_EVENT_DISCONNECTED:
+    slot->connected = false;
+    break;
+  case HTTP_EVENT_ON_HEADER:
+    poll_scheduler_note_header(slot->host, evt->header_key,
+                               evt->header_value);
+    break;
+  case HTTP_EVENT_ON_DATA:
+    // Chunked and content-length bodies alike: the client has already
+    // removed the chunk framing, so every piece goes straight to the parser
+    slot->data_seen = true;
+    if (slot->request && slot->request->scanner) {
+      json_scanner_feed(slot->request->scanner, evt->data, evt->data_len);
+    }
+    break;
+  default:
+    break;
+  }
+
+  if (!slot->request || !slot->request->event_handler) {
+    return ESP_OK;
+  }
+  evt->user_data = slot->request->user_data;
+  esp_err_t err = slot->request->event_handler(evt);
+  evt->user_data = slot;
+  return err;
+}
+
+static esp_http_client_handle_t get_client(http_conn_slot_t *slot) {
+  if (slot->client) {
+    return slot->client;
+  }
+
+  const http_host_info_t *info = &host_info[slot->host];
+  esp_http_client_config_t config = {
+      .url = info->base_url,
+      .method = HTTP_METHOD_GET,
+      .event_handler = http_conn_event_handler,
+      .user_data = slot,
+      .buffer_size = info->buffer_size,
+      .buffer_size_tx = info->buffer_size,
+      .timeout_ms = HTTP_CONN_TIMEOUT_MS,
+      .keep_alive_enable = true,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+      // Resume the TLS session when the server has closed the keep-alive
+      // connection instead of doing a full ECDHE handshake
+      .save_client_session = true,
+#endif
+  };
+
+  slot->client = esp_http_client_init(&config);
+  if (!slot->client) {
+    ESP_LOGE(TAG, "Failed to initialize HTTP client for %s", info->name);
+    return NULL;
+  }
+
+  // Headers persist on the handle across requests
+  esp_http_client_set_header(slot->client, "Authorization",
+                             info->authorization);
+  esp_http_client_set_header(slot->client, "User-Agent", info->user_agent);
+  esp_http_client_set_header(slot->client, "Accept", info->accept);
+  return slot->client;
+}
+
+esp_err_t http_conn_perform(http_host_t host, const http_conn_request_t *request,
+                            int *status_code) {
+  if (host >= HTTP_HOST_COUNT || !request || !request->url || !status_code) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  http_conn_slot_t *slot = acquire_slot(host);
+  if (!slot) {
+    ESP_LOGE(TAG, "No idle %s connection", host_info[host].name);
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_http_client_handle_t client = get_client(slot);
+  if (!client) {
+    release_slot(slot);
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_err_t err = esp_http_client_set_url(client, request->url);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set URL: %s", esp_err_to_name(err));
+    release_slot(slot);
+    return err;
+  }
+  esp_http_client_set_method(client, request->method);
+  if (request->method == HTTP_METHOD_POST && request->post_data) {
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_post_field(client, request->post_data,
+                                   strlen(request->post_data));
+  }
+  if (request->if_none_match) {
+    esp_http_client_set_header(client, "If-None-Match", request->if_none_match);
+  }
+
+  slot->request = request;
+  slot->cycle.requests++;
+  slot->total.requests++;
+
+  // A reused socket may have been closed by the server while idle. Replay
+  // once on a fresh connection, but only if no body bytes reached the handler.
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = slot->connected;
+    slot->data_seen = false;
+    slot->connect_start_us = esp_timer_get_time();
+
+    err = esp_http_client_perform(client);
+    if (err == ESP_OK) {
+      break;
+    }
+
+    esp_http_client_close(client);
+    slot->connected = false;
+    if (!reused || slot->data_seen) {
+      break;
+    }
+    ESP_LOGW(TAG, "Stale %s connection (%s), reconnecting",
+             host_info[host].name, esp_err_to_name(err));
+    slot->cycle.retries++;
+    slot->total.retries++;
+  }
+
+  slot->request = NULL;
+  if (request->if_none_match) {
+    esp_http_client_delete_header(client, "If-None-Match");
+  }
+  if (request->method == HTTP_METHOD_POST && request->post_data) {
+    esp_http_client_set_post_field(client, NULL, 0);
+    esp_http_client_delete_header(client, "Content-Type");
+  }
+  if (err == ESP_OK) {
+    *status_code = esp_http_client_get_status_code(client);
+    if (*status_code == 304) {
+      slot->cycle.not_modified++;
+      slot->total.not_modified++;
+    }
+  }
+  release_slot(slot);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  poll_scheduler_note_status(host, *status_code);
+  return ESP_OK;
+}
+
+// Sum a host's per-connection counters
+static void sum_stats(http_host_t host, http_conn_stats_t *cycle,
+                      http_conn_stats_t *total) {
+  memset(cycle, 0, sizeof(*cycle));
+  memset(total, 0, sizeof(*total));
+  for (int i = 0; i < HTTP_CONN_POOL_SIZE; i++) {
+    const http_conn_slot_t *slot = &slots[host][i];
+#define ADD(field)                                                             \
+  cycle->field += slot->cycle.field;                                           \
+  total->field += slot->total.field;
+    ADD(requests)
+    ADD(not_modified)
+    ADD(handshakes)
+    ADD(retries)
+    ADD(session_resumed)
+    ADD(session_full)
+    ADD(resumed_ms)
+    ADD(full_ms)
+#undef ADD
+  }
+}
+
+void http_conn_cycle_begin(void) {
+  for (int i = 0; i < HTTP_HOST_COUNT; i++) {
+    for (int j = 0; j < HTTP_CONN_POOL_SIZE; j++) {
+      memset(&slots[i][j].cycle, 0, sizeof(slots[i][j].cycle));
+    }
+  }
+}
+
+void http_conn_cycle_end(void) {
+  for (int i = 0; i < HTTP_HOST_COUNT; i++) {
+    http_conn_stats_t cycle;
+    http_conn_stats_t total;
+    sum_stats((http_host_t)i, &cycle, &total);
+    if (cycle.requests == 0) {
+      continue;
+    }
+    ESP_LOGI(TAG,
+             "%s cycle: %lu requests, %lu handshakes, %lu retries "
+             "(total: %lu requests, %lu handshakes)",
+             host_info[i].name, (unsigned long)cycle.requests,
+             (unsigned long)cycle.handshakes, (unsigned long)cycle.retries,
+             (unsigned long)total.requests, (unsigned long)total.handshakes);
+    if (cycle.handshakes == 0) {
+      continue;
+    }
+    ESP_LOGI(TAG,
+             "%s TLS sessions: %lu resumed (avg %lu ms), %lu full "
+             "(avg %lu ms)",
+             host_info[i].name, (unsigned long)total.session_resumed,
+             (unsigned long)(total.session_resumed
+                                 ? total.resumed_ms / total.session_resumed
+                                 : 0),
+             (unsigned long)total.session_full,
+             (unsigned long)(total.session_full
+                                 ? total.full_ms / total.session_full
+                                 : 0));
+  }
+}
+
+void http_conn_get_cycle_stats(http_host_t host, http_conn_stats_t *stats) {
+  if (host >= HTTP_HOST_COUNT || !stats) {
+    return;
+  }
+  http_conn_stats_t total;
+  sum_stats(host, stats, &total);
+}
+
+const char *http_conn_host_name(http_host_t host) {
+  return host < HTTP_HOST_COUNT ? host_info[host].name : "?";
+}
+
+void http_conn_close_all(void) {
+  for (int i = 0; i < HTTP_HOST_COUNT; i++) {
+    for (int j = 0; j < HTTP_CONN_POOL_SIZE; j++) {
+      http_conn_slot_t *slot = &slots[i][j];
+      if (slot->client) {
+        esp_http_client_cleanup(slot->client);
+        slot->client = NULL;
+        slot->connected = false;
+        slot->has_session = false;
+      }
+    }
+  }
+}
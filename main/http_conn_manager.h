@@ -0,0 +1,89 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_client.h"
+#include "json_scanner.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+
+// API hosts - up to HTTP_CONN_POOL_SIZE persistent keep-alive connections are
+// held open per host, one per concurrent request
+// X(name, base_url, authorization, user_agent, accept, buffer_size)
+#define HTTP_CONN_HOSTS                                                        \
+  X(GITHUB, "https://api.github.com", "token " CONFIG_GITHUB_AUTH_TOKEN,       \
+    "ESP32-GitHub-Status", "application/vnd.github.v3+json", 512)              \
+  X(VERCEL, "https://api.vercel.com", "Bearer " CONFIG_VERCEL_AUTH_TOKEN,      \
+    "ESP32-Vercel-Status", "application/json", 2048)
+
+#define X(name, base, auth, ua, accept, buf) HTTP_HOST_##name,
+typedef enum { HTTP_CONN_HOSTS HTTP_HOST_COUNT } http_host_t;
+#undef X
+
+#define HTTP_CONN_TIMEOUT_MS 10000
+#define HTTP_CONN_POOL_SIZE CONFIG_FETCH_CONCURRENCY
+
+typedef struct {
+  const char *url;
+  esp_http_client_method_t method; // defaults to GET
+  const char *post_data;           // JSON body, sent when method is POST
+  json_scanner_t *scanner;          // body is fed here as it arrives
+  http_event_handle_cb event_handler; // receives evt->user_data = user_data
+  void *user_data;
+  const char *if_none_match; // optional ETag for a conditional request
+} http_conn_request_t;
+
+typedef struct {
+  uint32_t requests;
+  uint32_t not_modified; // 304 answers, free against GitHub's rate limit
+  uint32_t handshakes; // new TCP+TLS connections opened
+  uint32_t retries;    // requests replayed after a stale keep-alive socket
+  // TLS session resumption: handshakes offered a cached session ticket vs.
+  // full handshakes, with total connect+handshake time for each. A ticket
+  // the server rejects still counts as resumed but shows full-length time.
+  uint32_t session_resumed;
+  uint32_t session_full;
+  uint32_t resumed_ms;
+  uint32_t full_ms;
+} http_conn_stats_t;
+
+/**
+ * @brief Perform a request on a pooled connection for a host
+ *
+ * Safe to call from several tasks at once. Takes an idle connection from the
+ * host's pool, preferring one that is still open, and reconnects
+ * transparently (one retry) if the server closed it while idle. Fails with
+ * ESP_ERR_NO_MEM when more than HTTP_CONN_POOL_SIZE requests to the host are
+ * already in flight.
+ *
+ * @param host Host the request URL belongs to
+ * @param request URL and event handler for this request
+ * @param status_code Filled with the HTTP status code on success
+ * @return esp_err_t ESP_OK if a response was received
+ */
+esp_err_t http_conn_perform(http_host_t host, const http_conn_request_t *request,
+                            int *status_code);
+
+/**
+ * @brief Reset the per-cycle counters, call at the start of each poll cycle
+ */
+void http_conn_cycle_begin(void);
+
+/**
+ * @brief Log the per-cycle request/handshake counters for every used host
+ */
+void http_conn_cycle_end(void);
+
+/**
+ * @brief Get the counters for the current cycle, summed over the host's pool
+ */
+void http_conn_get_cycle_stats(http_host_t host, http_conn_stats_t *stats);
+
+/**
+ * @brief Get the display name of a host ("GITHUB", "VERCEL")
+ */
+const char *http_conn_host_name(http_host_t host);
+
+/**
+ * @brief Close and free every open connection
+ */
+void http_conn_close_all(void);
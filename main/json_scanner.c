@@ -0,0 +1,174 @@
+#include "json_scanner.h"
+#include "string.h"
+
+enum {
+  SCAN_VALUE,   // between tokens
+  SCAN_STRING,  // inside a string
+  SCAN_ESCAPE,  // after a backslash inside a string
+  SCAN_LITERAL, // inside a number, true, false or null
+};
+
+void json_scanner_init(json_scanner_t *scanner, const json_scan_key_t *keys,
+                       int key_count, uint8_t element_depth, json_scan_cb_t cb,
+                       void *ctx) {
+  memset(scanner, 0, sizeof(*scanner));
+  scanner->keys = keys;
+  scanner->key_count = key_count;
+  scanner->element_depth = element_depth;
+  scanner->cb = cb;
+  scanner->ctx = ctx;
+  scanner->state = SCAN_VALUE;
+  scanner->pending_key = -1;
+  scanner->status = JSON_SCAN_MORE;
+}
+
+static void token_append(json_scanner_t *scanner, char c) {
+  if (scanner->token_len < JSON_SCAN_TOKEN_SIZE - 1) {
+    scanner->token[scanner->token_len++] = c;
+  } else {
+    scanner->token_overflow = true;
+  }
+}
+
+static void emit(json_scanner_t *scanner, int key_index, const char *value) {
+  if (!scanner->cb(scanner->ctx, key_index, value)) {
+    scanner->status = JSON_SCAN_DONE;
+  }
+}
+
+static void match_key(json_scanner_t *scanner) {
+  scanner->pending_key = -1;
+  if (scanner->token_overflow) {
+    return;
+  }
+  scanner->token[scanner->token_len] = '\0';
+  for (int i = 0; i < scanner->key_count; i++) {
+    if (scanner->keys[i].depth == scanner->depth &&
+        strcmp(scanner->keys[i].name, scanner->token) == 0) {
+      scanner->pending_key = i;
+      return;
+    }
+  }
+}
+
+static void end_value(json_scanner_t *scanner) {
+  if (scanner->pending_key >= 0) {
+    scanner->token[scanner->token_len] = '\0';
+    int key_index = scanner->pending_key;
+    scanner->pending_key = -1;
+    emit(scanner, key_index, scanner->token);
+  }
+}
+
+static bool in_object(const json_scanner_t *scanner) {
+  return scanner->object_mask & (1u << scanner->depth);
+}
+
+// Handle a character outside strings and literals
+static void scan_structural(json_scanner_t *scanner, char c) {
+  switch (c) {
+  case ' ':
+  case '\t':
+  case '\r':
+  case '\n':
+    break;
+  case ':':
+    scanner->expect_key = false;
+    break;
+  case ',':
+    scanner->expect_key = in_object(scanner);
+    break;
+  case '"':
+    scanner->state = SCAN_STRING;
+    scanner->string_is_key = scanner->expect_key;
+    scanner->token_len = 0;
+    scanner->token_overflow = false;
+    break;
+  case '{':
+  case '[':
+    if (scanner->depth >= JSON_SCAN_MAX_DEPTH - 1) {
+      scanner->status = JSON_SCAN_ERROR;
+      return;
+    }
+    if (scanner->pending_key >= 0) {
+      // Requested key with a container value
+      int key_index = scanner->pending_key;
+      scanner->pending_key = -1;
+      emit(scanner, key_index, NULL);
+    }
+    scanner->depth++;
+    if (c == '{') {
+      scanner->object_mask |= 1u << scanner->depth;
+    } else {
+      scanner->object_mask &= ~(1u << scanner->depth);
+    }
+    scanner->expect_key = (c == '{');
+    break;
+  case '}':
+  case ']':
+    if (scanner->depth == 0) {
+      scanner->status = JSON_SCAN_ERROR;
+      return;
+    }
+    if (c == '}' && scanner->depth == scanner->element_depth) {
+      emit(scanner, JSON_SCAN_ELEMENT_END, NULL);
+    }
+    scanner->depth--;
+    scanner->expect_key = false;
+    break;
+  default:
+    // Start of a number, true, false or null
+    scanner->state = SCAN_LITERAL;
+    scanner->token_len = 0;
+    scanner->token_overflow = false;
+    token_append(scanner, c);
+    break;
+  }
+}
+
+json_scan_status_t json_scanner_feed(json_scanner_t *scanner, const char *data,
+                                     size_t len) {
+  for (size_t i = 0; i < len && scanner->status == JSON_SCAN_MORE; i++) {
+    char c = data[i];
+
+    switch (scanner->state) {
+    case SCAN_STRING:
+      if (c == '\\') {
+        scanner->state = SCAN_ESCAPE;
+      } else if (c == '"') {
+        scanner->state = SCAN_VALUE;
+        if (scanner->string_is_key) {
+          match_key(scanner);
+        } else {
+          end_value(scanner);
+        }
+      } else if (scanner->string_is_key || scanner->pending_key >= 0) {
+        token_append(scanner, c);
+      }
+      break;
+    case SCAN_ESCAPE:
+      // Keep the escaped character as-is; values of interest are plain ASCII
+      scanner->state = SCAN_STRING;
+      if (scanner->string_is_key || scanner->pending_key >= 0) {
+        token_append(scanner, c);
+      }
+      break;
+    case SCAN_LITERAL:
+      if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' ||
+          c == '\r' || c == '\n') {
+        scanner->state = SCAN_VALUE;
+        end_value(scanner);
+        if (scanner->status == JSON_SCAN_MORE) {
+          scan_structural(scanner, c);
+        }
+      } else {
+        token_append(scanner, c);
+      }
+      break;
+    default:
+      scan_structural(scanner, c);
+      break;
+    }
+  }
+  return scanner->status;
+}
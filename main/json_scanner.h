@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest key or value the scanner captures; longer values are truncated and
+// longer keys never match
+#define JSON_SCAN_TOKEN_SIZE 48
+// Deepest container nesting tracked ({ and [ both count)
+#define JSON_SCAN_MAX_DEPTH 32
+
+typedef struct {
+  const char *name;
+  uint8_t depth; // container depth the key appears at, 1 = top-level object
+} json_scan_key_t;
+
+/**
+ * @brief Called for each requested key found at its depth
+ *
+ * @param ctx Caller context
+ * @param key_index Index into the key table, or JSON_SCAN_ELEMENT_END when an
+ * object at element_depth closes
+ * @param value Scalar value (strings unquoted, literals as-is), or NULL when
+ * the key's value is an object or array
+ * @return false to stop scanning (all needed fields read)
+ */
+typedef bool (*json_scan_cb_t)(void *ctx, int key_index, const char *value);
+
+#define JSON_SCAN_ELEMENT_END (-1)
+
+typedef enum {
+  JSON_SCAN_MORE,  // feed more data
+  JSON_SCAN_DONE,  // callback asked to stop
+  JSON_SCAN_ERROR, // malformed or too deeply nested input
+} json_scan_status_t;
+
+typedef struct {
+  const json_scan_key_t *keys;
+  int key_count;
+  uint8_t element_depth; // report object ends at this depth, 0 = never
+  json_scan_cb_t cb;
+  void *ctx;
+
+  // Tokenizer state
+  uint8_t state;
+  uint8_t depth;
+  uint32_t object_mask; // bit n set: container at depth n is an object
+  bool expect_key;
+  bool string_is_key;
+  int pending_key; // key whose value comes next, -1 if none
+  char token[JSON_SCAN_TOKEN_SIZE];
+  size_t token_len;
+  bool token_overflow;
+  json_scan_status_t status;
+} json_scanner_t;
+
+/**
+ * @brief Prepare a scanner for a new document
+ *
+ * @param scanner Scanner state, typically on the caller's stack
+ * @param keys Keys to extract; only these are ever copied
+ * @param key_count Number of keys
+ * @param element_depth Depth of the objects to report closes for, 0 for none
+ * @param cb Value callback
+ * @param ctx Passed through to the callback
+ */
+void json_scanner_init(json_scanner_t *scanner, const json_scan_key_t *keys,
+                       int key_count, uint8_t element_depth, json_scan_cb_t cb,
+                       void *ctx);
+
+/**
+ * @brief Consume the next chunk of the document
+ *
+ * Chunks may split tokens anywhere. Once the scanner is done or has failed,
+ * further data is ignored.
+ *
+ * @return json_scan_status_t Scanner status after this chunk
+ */
+json_scan_status_t json_scanner_feed(json_scanner_t *scanner, const char *data,
+                                     size_t len);
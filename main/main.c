@@ -1,51 +1,199 @@
+#include "display_bench.h"
 #include "display_manager.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "fetch_pool.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "gh_status_manager.h"
+#include "http_conn_manager.h"
+#include "poll_scheduler.h"
 #include "portmacro.h"
+#include "power_manager.h"
+#include "relay.h"
+#include "status_store.h"
 #include "sdkconfig.h"
+#include "string.h"
 #include "utils.h"
 #include "vercel_status_manager.h"
+#include "webhook_server.h"
 #include "wifi_manager.h"
+#include <stdio.h>
 
 static const char *TAG = "github_status";
 
-void write_status_to_display(const char *environment, const char *status) {
-  display_manager_write_text(environment);
-  int r = 255;
-  int g = 255;
-  int b = 0; // yellow
-  if (strcasecmp(status, "success") == 0) {
-    r = 0;
-    g = 255;
-    b = 0; // green
-  } else if (strcasecmp(status, "failure") == 0 ||
-             strcasecmp(status, "error") == 0) {
-    r = 255;
-    g = 0;
-    b = 0; // red
-  } else if (strcasecmp(status, "pending") == 0 ||
-             strcasecmp(status, "in_progress") == 0 ||
-             strcasecmp(status, "in progress") == 0 ||
-             strcasecmp(status, "queued") == 0 ||
-             strcasecmp(status, "inactive") == 0 ||
-             strcasecmp(status, "unknown") == 0) {
-    r = 128;
-    g = 128;
-    b = 128; // gray
+// Targets shown on the panel, from the active provider's X-macro table
+#ifdef CONFIG_USE_VERCEL
+#define STATUS_TARGETS VERCEL_TARGETS
+#define check_deployment_status vercel_check_deployment_status
+#define status_manager_init vercel_status_manager_init
+#else
+#define STATUS_TARGETS GITHUB_TARGETS
+#define check_deployment_status gh_check_deployment_status
+#define status_manager_init gh_status_manager_init
+#endif
+
+#define X(name, ...) #name,
+static const char *const environments[] = {STATUS_TARGETS};
+#undef X
+#define ENVIRONMENT_COUNT                                                      \
+  ((int)(sizeof(environments) / sizeof(environments[0])))
+
+_Static_assert(ENVIRONMENT_COUNT <= POLL_MAX_ENVIRONMENTS,
+               "too many environments for the poll scheduler");
+_Static_assert(ENVIRONMENT_COUNT <= FETCH_POOL_QUEUE_LENGTH,
+               "too many environments for the fetch queues");
+_Static_assert(ENVIRONMENT_COUNT <= DISPLAY_DASHBOARD_MAX_ROWS,
+               "too many environments for the dashboard");
+
+// Last known state per environment, kept between polls
+static deploy_state_t states[ENVIRONMENT_COUNT];
+// Showing the state saved before the last reboot, until a fetch succeeds
+static bool stale[ENVIRONMENT_COUNT];
+
+// Row marker for an environment whose fetch is in flight
+#define REFRESHING_NOTE "refreshing"
+
+// Show one environment's state as soon as it is known; only changed labels
+// redraw
+static void show_env(int env) {
+  stale[env] = false;
+  display_manager_dashboard_set_state(env, states[env]);
+  display_manager_dashboard_set_note(env, NULL);
+
+#ifdef CONFIG_ROLE_RELAY
+  // Subscribed panels on the LAN show the same thing, less the saved states
+  // not confirmed yet
+  deploy_state_t published[ENVIRONMENT_COUNT];
+  for (int i = 0; i < ENVIRONMENT_COUNT; i++) {
+    published[i] = stale[i] ? DEPLOY_STATE_UNKNOWN : states[i];
+  }
+  relay_publish(published, ENVIRONMENT_COUNT);
+#endif
+}
+
+static void show_checked_time(void) {
+  char time_str[9];
+  get_human_real_time(time_str);
+  char last_checked_str[32];
+  snprintf(last_checked_str, sizeof(last_checked_str), "checked: %s",
+           time_str);
+  display_manager_dashboard_set_bottom(last_checked_str);
+}
+
+// Put the dashboard up with the states saved before the last reboot, marked
+// stale with the date and time each was first seen, before anything is
+// fetched
+static void show_saved_states(void) {
+  display_manager_set_bg_color(0, 0, 0);
+  display_manager_dashboard_create(environments, ENVIRONMENT_COUNT,
+                                   TEXT_SIZE_22);
+  if (status_store_init() != ESP_OK) {
+    return;
+  }
+
+  for (int i = 0; i < ENVIRONMENT_COUNT; i++) {
+    status_record_t record;
+    if (!status_store_load(i, environments[i], &record)) {
+      continue;
+    }
+    states[i] = record.state;
+    stale[i] = true;
+
+    char note[DISPLAY_DASHBOARD_NOTE_LEN] = "stale";
+    char time_str[13];
+    if (record.seen &&
+        format_human_date_time(record.seen, time_str) == ESP_OK) {
+      snprintf(note, sizeof(note), "stale %s", time_str);
+    }
+    display_manager_dashboard_set_state(i, record.state);
+    display_manager_dashboard_set_note(i, note);
+  }
+}
+
+// Record and show a fresh state. Failed fetches leave a saved state up, and
+// unknown says nothing worth keeping over the last real state.
+static void record_result(const fetch_result_t *result) {
+  if (result->err != ESP_OK && stale[result->env]) {
+    return;
+  }
+  states[result->env] = result->state;
+  if (result->err == ESP_OK && result->state != DEPLOY_STATE_UNKNOWN) {
+    status_store_save(result->env, environments[result->env], result->state,
+                      result->deployment_id);
+  }
+  show_env(result->env);
+}
+
+#ifdef CONFIG_ROLE_SUBSCRIBER
+// The relay does all the polling; show its snapshots as they arrive
+static void subscriber_loop(void) {
+  while (1) {
+    fetch_result_t result;
+    fetch_pool_wait(&result, portMAX_DELAY);
+    record_result(&result);
+    show_checked_time();
+  }
+}
+#else
+static void apply_result(const fetch_result_t *result, int64_t now_ms) {
+  poll_scheduler_env_update(result->env, result->state, now_ms);
+  record_result(result);
+}
+
+static void poll_loop(void) {
+  while (1) {
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    http_conn_cycle_begin();
+
+    // Fetch the environments whose cadence says they are due in parallel.
+    // Workers take them in table order, production first; each row keeps its
+    // old value, marked as refreshing (or stale), until its result is shown.
+    int pending = 0;
+    for (int i = 0; i < ENVIRONMENT_COUNT; i++) {
+      if (poll_scheduler_env_due(i, now_ms) &&
+          fetch_pool_submit(i, environments[i]) == ESP_OK) {
+        if (!stale[i]) {
+          display_manager_dashboard_set_note(i, REFRESHING_NOTE);
+        }
+        pending++;
+      }
+    }
+    fetch_result_t result;
+    while (pending > 0) {
+      fetch_pool_wait(&result, portMAX_DELAY);
+      if (!result.pushed) {
+        pending--;
+      }
+      apply_result(&result, now_ms);
+    }
+
+    http_conn_cycle_end();
+    poll_scheduler_report_ages(esp_timer_get_time() / 1000, environments,
+                               ENVIRONMENT_COUNT);
+    show_checked_time();
+
+    // Sleep until the next poll, showing pushed updates as they arrive
+    now_ms = esp_timer_get_time() / 1000;
+    int64_t wake_ms = now_ms + poll_scheduler_next_delay_ms(now_ms);
+    while (now_ms < wake_ms &&
+           fetch_pool_wait(&result, pdMS_TO_TICKS(wake_ms - now_ms))) {
+      now_ms = esp_timer_get_time() / 1000;
+      apply_result(&result, now_ms);
+      show_checked_time();
+    }
   }
-  text_config_t config = {
-      .color =
-          {
-              .r = r,
-              .g = g,
-              .b = b,
-          },
-      .size = TEXT_SIZE_22,
-  };
-  display_manager_write_text_custom(status, config);
+}
+#endif
+
+// Replace the screen with the error and stop
+static void boot_failed(const char *text) {
+  ESP_LOGE(TAG, "%s", text);
+  display_manager_clear();
+  display_manager_set_bg_color(255, 0, 0);
+  display_manager_write_text_color(text, 0, 0, 0);
+  vTaskDelay(portMAX_DELAY);
 }
 
 void app_main(void) {
@@ -67,82 +215,60 @@ void app_main(void) {
   ESP_LOGI(TAG, "  WiFi SSID: %s", CONFIG_WIFI_SSID);
   ESP_LOGI(TAG, "  WiFi Password: %s", CONFIG_WIFI_PASSWORD);
 
+#ifdef CONFIG_POWER_LIGHT_SLEEP
+  // Not fatal: the board just draws more current
+  power_manager_init();
+#endif
+
   display_manager_init();
+#ifdef CONFIG_DISPLAY_BENCHMARK
+  display_bench_run();
+#endif
 
-  // Small delay to ensure display is ready
-  vTaskDelay(pdMS_TO_TICKS(100));
-  display_manager_clear();
-  display_manager_set_bg_color(0, 255, 255);
-
-  display_manager_write_text_color("init wifi...", 0, 0, 0);
-  esp_err_t err = wifi_manager_init();
-  if (err != ESP_OK) {
-    display_manager_set_bg_color(255, 0, 0);
-    display_manager_write_text_color("  failed to connect", 0, 0, 0);
-    vTaskDelay(portMAX_DELAY);
+  // Boot progress goes on the bottom strip, under the saved states
+  show_saved_states();
+
+  display_manager_dashboard_set_bottom("init wifi...");
+  if (wifi_manager_init() != ESP_OK) {
+    boot_failed("wifi failed to connect");
   }
-  display_manager_write_text_color("  wifi connected", 0, 0, 0);
-  vTaskDelay(pdMS_TO_TICKS(500));
 
   // Initialize utils module (SNTP)
-  display_manager_write_text_color("init time sync...", 0, 0, 0);
-  esp_err_t time_err = utils_init();
-  if (time_err != ESP_OK) {
-    display_manager_set_bg_color(255, 0, 0);
-    display_manager_write_text_color("  time sync failed", 0, 0, 0);
-    vTaskDelay(portMAX_DELAY);
+  display_manager_dashboard_set_bottom("init time sync...");
+  if (utils_init() != ESP_OK) {
+    boot_failed("time sync failed");
   }
-  display_manager_write_text_color("  time synced", 0, 0, 0);
-  vTaskDelay(pdMS_TO_TICKS(500));
 
-  display_manager_write_text_color("init complete", 0, 0, 0);
-  vTaskDelay(pdMS_TO_TICKS(500));
-
-  display_manager_clear();
-  display_manager_set_bg_color(0, 0, 0);
-  display_manager_write_text("checking status...");
-  vTaskDelay(pdMS_TO_TICKS(1000));
-
-  while (1) {
-// Generate status variables and check deployment status
-#ifdef CONFIG_USE_VERCEL
-// Use Vercel API
-#define CHECK_ENV(env)                                                         \
-  char env##_status[32];                                                       \
-  vercel_check_deployment_status(#env, env##_status, sizeof(env##_status));
-    CHECK_ENV(production)
-    CHECK_ENV(staging)
-#undef CHECK_ENV
+#ifdef CONFIG_ROLE_SUBSCRIBER
+  display_manager_dashboard_set_bottom("join relay...");
+  if (fetch_pool_init(NULL) != ESP_OK ||
+      relay_subscriber_start(ENVIRONMENT_COUNT) != ESP_OK) {
+    boot_failed("relay join failed");
+  }
 #else
-// Use GitHub API
-#define CHECK_ENV(env)                                                         \
-  char env##_status[32];                                                       \
-  gh_check_deployment_status(#env, env##_status, sizeof(env##_status));
-    CHECK_ENV(production)
-    CHECK_ENV(staging)
-    CHECK_ENV(preview)
-#undef CHECK_ENV
+  if (status_manager_init() != ESP_OK ||
+      fetch_pool_init(check_deployment_status) != ESP_OK) {
+    boot_failed("fetch workers failed");
+  }
+#endif
+#ifdef CONFIG_ROLE_RELAY
+  if (relay_publisher_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Relay unavailable");
+  }
 #endif
 
-    display_manager_clear();
-
-// Generate display calls
-#ifdef CONFIG_USE_VERCEL
-    write_status_to_display("production", production_status);
-    write_status_to_display("staging", staging_status);
-#else
-    write_status_to_display("production", production_status);
-    write_status_to_display("staging", staging_status);
-    write_status_to_display("preview", preview_status);
+#ifdef CONFIG_WEBHOOK_ENABLE
+  // Not fatal: polling still reconciles every environment
+  if (webhook_server_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Webhooks unavailable");
+  }
 #endif
 
-    char time_str[9];
-    get_human_real_time(time_str);
-    char last_checked_str[32];
-    snprintf(last_checked_str, sizeof(last_checked_str), "checked: %s",
-             time_str);
-    display_manager_write_text_bottom(last_checked_str);
+  display_manager_dashboard_set_bottom("checking status...");
 
-    vTaskDelay(pdMS_TO_TICKS(CONFIG_STATUS_CHECK_INTERVAL * 1000));
-  }
+#ifdef CONFIG_ROLE_SUBSCRIBER
+  subscriber_loop();
+#else
+  poll_loop();
+#endif
 }
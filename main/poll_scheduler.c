@@ -0,0 +1,254 @@
+#include "poll_scheduler.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "string.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <strings.h>
+
+static const char *TAG = "POLL_SCHED";
+
+typedef struct {
+  bool budget_known;
+  uint32_t remaining;    // X-RateLimit-Remaining
+  time_t reset_at;       // X-RateLimit-Reset (epoch seconds)
+  time_t retry_after_at; // Retry-After, or reset time after a 403/429
+} rate_limit_t;
+
+static rate_limit_t rate_limits[HTTP_HOST_COUNT];
+// Headers and status codes arrive from every fetch worker
+static portMUX_TYPE rate_limit_lock = portMUX_INITIALIZER_UNLOCKED;
+
+typedef struct {
+  bool polled;
+  int64_t next_due_ms;
+  int64_t updated_ms; // last poll result or pushed status
+  uint32_t interval_s; // current terminal-state interval, grows while idle
+  deploy_state_t last_state;
+} env_cadence_t;
+
+static env_cadence_t cadences[POLL_MAX_ENVIRONMENTS];
+
+void poll_scheduler_note_header(http_host_t host, const char *key,
+                                const char *value) {
+  if (host >= HTTP_HOST_COUNT || !key || !value) {
+    return;
+  }
+  rate_limit_t *limit = &rate_limits[host];
+
+  if (strcasecmp(key, "X-RateLimit-Remaining") == 0) {
+    uint32_t remaining = strtoul(value, NULL, 10);
+    taskENTER_CRITICAL(&rate_limit_lock);
+    limit->remaining = remaining;
+    limit->budget_known = true;
+    taskEXIT_CRITICAL(&rate_limit_lock);
+  } else if (strcasecmp(key, "X-RateLimit-Reset") == 0) {
+    time_t reset_at = (time_t)strtoll(value, NULL, 10);
+    taskENTER_CRITICAL(&rate_limit_lock);
+    limit->reset_at = reset_at;
+    taskEXIT_CRITICAL(&rate_limit_lock);
+  } else if (strcasecmp(key, "Retry-After") == 0) {
+    // Delay-seconds form only; both APIs send seconds
+    time_t now = get_real_time();
+    if (now != 0) {
+      time_t retry_after_at = now + strtol(value, NULL, 10);
+      taskENTER_CRITICAL(&rate_limit_lock);
+      limit->retry_after_at = retry_after_at;
+      taskEXIT_CRITICAL(&rate_limit_lock);
+    }
+  }
+}
+
+void poll_scheduler_note_status(http_host_t host, int status_code) {
+  if (host >= HTTP_HOST_COUNT || (status_code != 403 && status_code != 429)) {
+    return;
+  }
+  rate_limit_t *limit = &rate_limits[host];
+  time_t now = get_real_time();
+
+  // Secondary limits send Retry-After; primary ones only exhaust the budget
+  taskENTER_CRITICAL(&rate_limit_lock);
+  if (limit->retry_after_at <= now && limit->budget_known &&
+      limit->remaining == 0) {
+    limit->retry_after_at = limit->reset_at;
+  }
+  time_t hold_until = limit->retry_after_at;
+  taskEXIT_CRITICAL(&rate_limit_lock);
+  ESP_LOGW(TAG, "Rate limited (HTTP %d), holding until %lld", status_code,
+           (long long)hold_until);
+}
+
+bool poll_scheduler_env_due(int env, int64_t now_ms) {
+  if (env < 0 || env >= POLL_MAX_ENVIRONMENTS) {
+    return false;
+  }
+  return !cadences[env].polled || now_ms >= cadences[env].next_due_ms;
+}
+
+void poll_scheduler_env_update(int env, deploy_state_t state, int64_t now_ms) {
+  if (env < 0 || env >= POLL_MAX_ENVIRONMENTS) {
+    return;
+  }
+  env_cadence_t *cadence = &cadences[env];
+  bool changed = !cadence->polled || cadence->last_state != state;
+  uint32_t interval_s;
+
+  if (deploy_state_is_transient(state)) {
+    interval_s = POLL_TRANSIENT_INTERVAL;
+    cadence->interval_s = 0; // restart backoff once it settles
+  } else if (changed || cadence->interval_s == 0) {
+    interval_s = POLL_BASE_INTERVAL;
+    cadence->interval_s = interval_s;
+  } else {
+    // Unchanged terminal state: back off exponentially
+    interval_s = cadence->interval_s * 2;
+    if (interval_s > CONFIG_POLL_MAX_INTERVAL) {
+      interval_s = CONFIG_POLL_MAX_INTERVAL > POLL_BASE_INTERVAL
+                       ? CONFIG_POLL_MAX_INTERVAL
+                       : POLL_BASE_INTERVAL;
+    }
+    cadence->interval_s = interval_s;
+  }
+
+  cadence->polled = true;
+  cadence->updated_ms = now_ms;
+  cadence->next_due_ms = now_ms + (int64_t)interval_s * 1000;
+  cadence->last_state = state;
+  ESP_LOGI(TAG, "env %d '%s': next poll in %lu s", env,
+           deploy_state_label(state), (unsigned long)interval_s);
+}
+
+// Cycle spacing that spreads the tightest host budget evenly up to its reset,
+// and how long a Retry-After or exhausted budget holds all polls, in seconds.
+// False if no host has reported a budget this cycle or spent any of it; 304
+// answers to conditional requests are not charged.
+static bool budget_delay_s(uint32_t *spacing_out, uint32_t *hold_out) {
+  *spacing_out = 0;
+  *hold_out = 0;
+  time_t now = get_real_time();
+  if (now == 0) {
+    return false; // no wall clock to compare reset times against
+  }
+
+  bool budget_seen = false;
+  uint32_t delay_s = 0;
+  for (int i = 0; i < HTTP_HOST_COUNT; i++) {
+    taskENTER_CRITICAL(&rate_limit_lock);
+    const rate_limit_t snapshot = rate_limits[i];
+    taskEXIT_CRITICAL(&rate_limit_lock);
+    const rate_limit_t *limit = &snapshot;
+    if (limit->retry_after_at > now) {
+      uint32_t wait_s = (uint32_t)(limit->retry_after_at - now) + 1;
+      *hold_out = wait_s > *hold_out ? wait_s : *hold_out;
+    }
+
+    http_conn_stats_t stats;
+    http_conn_get_cycle_stats((http_host_t)i, &stats);
+    uint32_t cost = stats.requests - stats.not_modified;
+    if (!limit->budget_known || cost == 0 || limit->reset_at <= now) {
+      continue;
+    }
+
+    // Keep a reserve for retries and for other clients sharing the token
+    uint32_t usable =
+        limit->remaining * (100 - CONFIG_RATE_LIMIT_RESERVE_PERCENT) / 100;
+    uint32_t cycles = usable / cost;
+    uint32_t window_s = (uint32_t)(limit->reset_at - now);
+    uint32_t spacing_s = cycles ? window_s / cycles : window_s + 1;
+    if (spacing_s < CONFIG_POLL_MIN_INTERVAL) {
+      spacing_s = CONFIG_POLL_MIN_INTERVAL;
+    }
+
+    budget_seen = true;
+    if (spacing_s > delay_s) {
+      delay_s = spacing_s;
+    }
+    ESP_LOGI(TAG,
+             "%s: %lu remaining, reset in %lu s, %lu req/cycle -> "
+             "%lu s spacing",
+             http_conn_host_name((http_host_t)i),
+             (unsigned long)limit->remaining, (unsigned long)window_s,
+             (unsigned long)cost, (unsigned long)spacing_s);
+  }
+  *spacing_out = delay_s;
+  return budget_seen;
+}
+
+uint32_t poll_scheduler_next_delay_ms(int64_t now_ms) {
+  uint32_t spacing_s, hold_s;
+  bool budget_seen = budget_delay_s(&spacing_s, &hold_s);
+  int64_t spacing_ms = (int64_t)spacing_s * 1000;
+
+#ifndef CONFIG_WEBHOOK_ENABLE
+  if (budget_seen) {
+    // Budget to spare: a deployment in flight is polled at the spacing when
+    // that is sooner than its own interval. Settled environments keep their
+    // backoff; the budget never brings them forward. With webhooks, changes
+    // arrive pushed and every poll stays at the reconcile interval.
+    for (int i = 0; i < POLL_MAX_ENVIRONMENTS; i++) {
+      env_cadence_t *cadence = &cadences[i];
+      if (cadence->polled && deploy_state_is_transient(cadence->last_state) &&
+          cadence->next_due_ms > now_ms + spacing_ms) {
+        cadence->next_due_ms = now_ms + spacing_ms;
+      }
+    }
+  }
+#endif
+
+  // Earliest environment due time
+  int64_t next_due_ms = now_ms + (int64_t)CONFIG_POLL_MAX_INTERVAL * 1000;
+  for (int i = 0; i < POLL_MAX_ENVIRONMENTS; i++) {
+    if (cadences[i].polled && cadences[i].next_due_ms < next_due_ms) {
+      next_due_ms = cadences[i].next_due_ms;
+    }
+  }
+  int64_t delay_ms = next_due_ms - now_ms;
+
+  // The spacing is a floor between cycles, also for overdue environments
+  if (budget_seen && spacing_ms > delay_ms) {
+    delay_ms = spacing_ms;
+  }
+  if ((int64_t)hold_s * 1000 > delay_ms) {
+    delay_ms = (int64_t)hold_s * 1000;
+  }
+  if (delay_ms < 0) {
+    delay_ms = 0;
+  }
+
+  ESP_LOGI(TAG, "Next poll in %lu ms", (unsigned long)delay_ms);
+  return (uint32_t)delay_ms;
+}
+
+void poll_scheduler_report_ages(int64_t now_ms, const char *const *names,
+                                int count) {
+  if (count > POLL_MAX_ENVIRONMENTS) {
+    count = POLL_MAX_ENVIRONMENTS;
+  }
+
+  int64_t max_ms = 0;
+  int64_t total_ms = 0;
+  int oldest = -1;
+  int reported = 0;
+  for (int i = 0; i < count; i++) {
+    if (!cadences[i].polled) {
+      continue;
+    }
+    int64_t age_ms = now_ms - cadences[i].updated_ms;
+    ESP_LOGD(TAG, "%s: %lld s old", names[i], (long long)(age_ms / 1000));
+    total_ms += age_ms;
+    reported++;
+    if (oldest < 0 || age_ms > max_ms) {
+      max_ms = age_ms;
+      oldest = i;
+    }
+  }
+  if (reported == 0) {
+    return;
+  }
+
+  ESP_LOGI(TAG, "Status age over %d targets: avg %lld s, max %lld s (%s)",
+           reported, (long long)(total_ms / reported / 1000),
+           (long long)(max_ms / 1000), names[oldest]);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "deploy_state.h"
+#include "esp_err.h"
+#include "http_conn_manager.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Upper bound on watched targets with their own poll cadence; each costs a
+// cadence record here and a status string in main and the relay snapshot
+#define POLL_MAX_ENVIRONMENTS 32
+
+#ifdef CONFIG_WEBHOOK_ENABLE
+// Webhooks deliver changes; polling only reconciles missed deliveries
+#define POLL_BASE_INTERVAL CONFIG_WEBHOOK_RECONCILE_INTERVAL
+#define POLL_TRANSIENT_INTERVAL CONFIG_WEBHOOK_RECONCILE_INTERVAL
+#else
+#define POLL_BASE_INTERVAL CONFIG_STATUS_CHECK_INTERVAL
+#define POLL_TRANSIENT_INTERVAL CONFIG_POLL_FAST_INTERVAL
+#endif
+
+/**
+ * @brief Record a response header from an API host
+ *
+ * Picks up X-RateLimit-Remaining, X-RateLimit-Reset and Retry-After; other
+ * headers are ignored. Called by the connection manager for every header.
+ */
+void poll_scheduler_note_header(http_host_t host, const char *key,
+                                const char *value);
+
+/**
+ * @brief Record the status code of a response from an API host
+ *
+ * 403/429 responses without a Retry-After hold the host until its reset.
+ */
+void poll_scheduler_note_status(http_host_t host, int status_code);
+
+/**
+ * @brief Check whether an environment is due for a poll
+ *
+ * Environments that were never polled are always due.
+ *
+ * @param env Environment index, below POLL_MAX_ENVIRONMENTS
+ * @param now_ms Monotonic time in milliseconds
+ */
+bool poll_scheduler_env_due(int env, int64_t now_ms);
+
+/**
+ * @brief Record a poll result and plan the environment's next poll
+ *
+ * Non-terminal states (queued, building, in progress) are polled every
+ * POLL_TRANSIENT_INTERVAL. Terminal states start at POLL_BASE_INTERVAL and
+ * double while unchanged, up to CONFIG_POLL_MAX_INTERVAL. Also call for
+ * statuses pushed by a webhook, which restarts the cadence.
+ *
+ * @param env Environment index, below POLL_MAX_ENVIRONMENTS
+ * @param state State returned by the provider
+ * @param now_ms Monotonic time in milliseconds
+ */
+void poll_scheduler_env_update(int env, deploy_state_t state, int64_t now_ms);
+
+/**
+ * @brief Compute the delay until the next poll cycle
+ *
+ * Call after http_conn_cycle_end(). Normally the earliest environment due
+ * time. Once a host reports its budget, the requests it charged this cycle
+ * (304s are free) set a spacing that spreads the remaining requests evenly
+ * up to its reset time. Cycles are never closer than that spacing, nor than
+ * CONFIG_POLL_MIN_INTERVAL. With budget to spare, environments in a
+ * non-terminal state are made due at the spacing when that is sooner than
+ * their own interval (not with CONFIG_WEBHOOK_ENABLE); terminal ones keep
+ * their backoff. Never before a
+ * Retry-After or an exhausted budget's reset.
+ *
+ * @param now_ms Monotonic time in milliseconds
+ * @return uint32_t Delay in milliseconds
+ */
+uint32_t poll_scheduler_next_delay_ms(int64_t now_ms);
+
+/**
+ * @brief Log how stale the shown statuses are
+ *
+ * Logs the oldest and average time since each environment's last update,
+ * and every environment's age at debug level. Call once per poll cycle.
+ *
+ * @param now_ms Monotonic time in milliseconds
+ * @param names Environment names, indexed like the cadences
+ * @param count Number of environments
+ */
+void poll_scheduler_report_ages(int64_t now_ms, const char *const *names,
+                                int count);
@@ -0,0 +1,97 @@
+#include "power_manager.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#ifdef CONFIG_POWER_LIGHT_SLEEP
+static const char *TAG = "power_manager";
+
+// Updated from the idle task with interrupts off, on the way out of sleep
+static power_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static IRAM_ATTR esp_err_t sleep_exit_cb(int64_t sleep_time_us, void *arg) {
+  taskENTER_CRITICAL_ISR(&stats_lock);
+  stats.wakeups++;
+  stats.slept_us += sleep_time_us;
+  taskEXIT_CRITICAL_ISR(&stats_lock);
+  return ESP_OK;
+}
+
+#if CONFIG_POWER_STATS_LOG_INTERVAL > 0
+static void stats_log_cb(void *arg) {
+  static power_stats_t last;
+  static int64_t last_us;
+  power_stats_t now;
+  power_manager_get_stats(&now);
+  int64_t now_us = esp_timer_get_time();
+
+  uint64_t slept_us = now.slept_us - last.slept_us;
+  ESP_LOGI(TAG, "%lu wakeups, asleep %llu%% of the time",
+           (unsigned long)(now.wakeups - last.wakeups),
+           (unsigned long long)(slept_us * 100 / (uint64_t)(now_us - last_us)));
+  last = now;
+  last_us = now_us;
+}
+#endif
+
+esp_err_t power_manager_get_stats(power_stats_t *out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  taskENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  taskEXIT_CRITICAL(&stats_lock);
+  return ESP_OK;
+}
+
+esp_err_t power_manager_init(void) {
+  ESP_LOGI(TAG, "Enable light sleep, %d-%d MHz", POWER_MIN_CPU_FREQ_MHZ,
+           POWER_MAX_CPU_FREQ_MHZ);
+
+  esp_pm_sleep_cbs_register_config_t cbs = {
+      .exit_cb = sleep_exit_cb,
+  };
+  esp_err_t err = esp_pm_light_sleep_register_cbs(&cbs);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register sleep callback: %s",
+             esp_err_to_name(err));
+    return err;
+  }
+
+  const esp_pm_config_t pm_config = {
+      .max_freq_mhz = POWER_MAX_CPU_FREQ_MHZ,
+      .min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ,
+      .light_sleep_enable = true,
+  };
+  err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to enable light sleep: %s", esp_err_to_name(err));
+    return err;
+  }
+
+#if CONFIG_POWER_STATS_LOG_INTERVAL > 0
+  const esp_timer_create_args_t stats_timer_args = {
+      .callback = stats_log_cb,
+      .name = "power_stats",
+      .skip_unhandled_events = true,
+  };
+  esp_timer_handle_t stats_timer;
+  ESP_ERROR_CHECK(esp_timer_create(&stats_timer_args, &stats_timer));
+  ESP_ERROR_CHECK(esp_timer_start_periodic(
+      stats_timer, (uint64_t)CONFIG_POWER_STATS_LOG_INTERVAL * 1000000));
+#endif
+
+  return ESP_OK;
+}
+#else
+esp_err_t power_manager_init(void) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t power_manager_get_stats(power_stats_t *stats) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+#endif // CONFIG_POWER_LIGHT_SLEEP
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+
+// CPU clock range for automatic frequency scaling: the default speed while
+// anything holds a PM lock (Wi-Fi, SPI transfers), the crystal when idle
+#define POWER_MAX_CPU_FREQ_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define POWER_MIN_CPU_FREQ_MHZ 40
+
+typedef struct {
+  uint32_t wakeups; // light sleep exits, whatever woke the chip
+  uint64_t slept_us;
+} power_stats_t;
+
+/**
+ * @brief Enable automatic light sleep and start counting wakeups
+ *
+ * The chip sleeps whenever every task is blocked, until the next timer, tick
+ * or interrupt is due.
+ *
+ * @return esp_err_t ESP_ERR_NOT_SUPPORTED without CONFIG_POWER_LIGHT_SLEEP
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief Copy the counters gathered since power_manager_init()
+ *
+ * @return esp_err_t ESP_ERR_NOT_SUPPORTED without CONFIG_POWER_LIGHT_SLEEP
+ */
+esp_err_t power_manager_get_stats(power_stats_t *stats);
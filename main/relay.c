@@ -0,0 +1,189 @@
+#include "relay.h"
+#include "esp_log.h"
+#include "fetch_pool.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "string.h"
+#include <errno.h>
+#include <stdbool.h>
+
+#ifndef CONFIG_ROLE_STANDALONE
+static const char *TAG = "RELAY";
+
+static int sock = -1;
+
+static int open_socket(void) {
+  int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+  if (fd < 0) {
+    ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+  }
+  return fd;
+}
+#endif
+
+#ifdef CONFIG_ROLE_RELAY
+static struct sockaddr_in group_addr;
+static relay_snapshot_t snapshot;
+static size_t snapshot_size; // 0 until the first publish
+static portMUX_TYPE snapshot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void send_snapshot(void) {
+  relay_snapshot_t copy;
+  taskENTER_CRITICAL(&snapshot_lock);
+  size_t size = snapshot_size;
+  memcpy(&copy, &snapshot, size);
+  taskEXIT_CRITICAL(&snapshot_lock);
+
+  if (size && sendto(sock, &copy, size, 0, (struct sockaddr *)&group_addr,
+                     sizeof(group_addr)) < 0) {
+    ESP_LOGW(TAG, "sendto failed: errno %d", errno);
+  }
+}
+
+static void relay_repeat_task(void *arg) {
+  while (1) {
+    vTaskDelay(pdMS_TO_TICKS(RELAY_REPEAT_MS));
+    send_snapshot();
+  }
+}
+
+esp_err_t relay_publisher_start(void) {
+  sock = open_socket();
+  if (sock < 0) {
+    return ESP_FAIL;
+  }
+
+  // Stay on the local network
+  uint8_t ttl = 1;
+  setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+  group_addr.sin_family = AF_INET;
+  group_addr.sin_port = htons(CONFIG_RELAY_PORT);
+  if (inet_aton(CONFIG_RELAY_GROUP, &group_addr.sin_addr) == 0) {
+    ESP_LOGE(TAG, "Invalid multicast group %s", CONFIG_RELAY_GROUP);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (xTaskCreate(relay_repeat_task, "relay", RELAY_TASK_STACK_SIZE, NULL,
+                  RELAY_TASK_PRIORITY, NULL) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "Publishing to %s:%d", CONFIG_RELAY_GROUP, CONFIG_RELAY_PORT);
+  return ESP_OK;
+}
+
+void relay_publish(const deploy_state_t *states, int count) {
+  if (count > POLL_MAX_ENVIRONMENTS) {
+    count = POLL_MAX_ENVIRONMENTS;
+  }
+
+  taskENTER_CRITICAL(&snapshot_lock);
+  snapshot.magic = RELAY_MAGIC;
+  snapshot.seq++;
+  snapshot.count = (uint8_t)count;
+  for (int i = 0; i < count; i++) {
+    snapshot.states[i] = (uint8_t)states[i];
+  }
+  snapshot_size = RELAY_SNAPSHOT_SIZE(count);
+  taskEXIT_CRITICAL(&snapshot_lock);
+
+  send_snapshot();
+}
+#endif // CONFIG_ROLE_RELAY
+
+#ifdef CONFIG_ROLE_SUBSCRIBER
+static int env_count;
+
+// Post every environment whose state differs from what was last posted
+static void post_changes(uint8_t *last, const uint8_t *states) {
+  for (int i = 0; i < env_count; i++) {
+    uint8_t state =
+        states[i] < DEPLOY_STATE_COUNT ? states[i] : DEPLOY_STATE_UNKNOWN;
+    if (last[i] == state) {
+      continue;
+    }
+    last[i] = state;
+
+    fetch_result_t result = {
+        .env = i,
+        .err = ESP_OK,
+        .state = (deploy_state_t)state,
+    };
+    fetch_pool_post(&result);
+  }
+}
+
+static void relay_listen_task(void *arg) {
+  static relay_snapshot_t packet;
+  // DEPLOY_STATE_COUNT: nothing posted yet, so the first snapshot posts
+  // every row, including ones that are DEPLOY_STATE_UNKNOWN
+  static uint8_t last[POLL_MAX_ENVIRONMENTS];
+  static const uint8_t unknown[POLL_MAX_ENVIRONMENTS];
+  uint16_t last_seq = 0;
+  bool synced = false;
+  memset(last, DEPLOY_STATE_COUNT, sizeof(last));
+
+  while (1) {
+    int len = recv(sock, &packet, sizeof(packet), 0);
+    if (len < 0) {
+      // Timed out: the relay is gone, don't keep showing its last word
+      if (synced) {
+        ESP_LOGW(TAG, "Relay silent for %d ms", RELAY_STALE_MS);
+        post_changes(last, unknown);
+        synced = false;
+      }
+      continue;
+    }
+    if (len < (int)RELAY_SNAPSHOT_SIZE(0) || packet.magic != RELAY_MAGIC ||
+        packet.count != env_count || len < (int)RELAY_SNAPSHOT_SIZE(env_count)) {
+      continue; // another firmware or configuration
+    }
+    if (synced && packet.seq == last_seq) {
+      continue; // repeat of a snapshot already applied
+    }
+    last_seq = packet.seq;
+    synced = true;
+    post_changes(last, packet.states);
+  }
+}
+
+esp_err_t relay_subscriber_start(int count) {
+  env_count = count;
+  sock = open_socket();
+  if (sock < 0) {
+    return ESP_FAIL;
+  }
+
+  struct sockaddr_in addr = {
+      .sin_family = AF_INET,
+      .sin_port = htons(CONFIG_RELAY_PORT),
+      .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    ESP_LOGE(TAG, "bind failed: errno %d", errno);
+    return ESP_FAIL;
+  }
+
+  struct ip_mreq mreq = {.imr_interface.s_addr = htonl(INADDR_ANY)};
+  if (inet_aton(CONFIG_RELAY_GROUP, &mreq.imr_multiaddr) == 0 ||
+      setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) <
+          0) {
+    ESP_LOGE(TAG, "Failed to join %s", CONFIG_RELAY_GROUP);
+    return ESP_FAIL;
+  }
+
+  struct timeval timeout = {
+      .tv_sec = RELAY_STALE_MS / 1000,
+      .tv_usec = (RELAY_STALE_MS % 1000) * 1000,
+  };
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  if (xTaskCreate(relay_listen_task, "relay", RELAY_TASK_STACK_SIZE, NULL,
+                  RELAY_TASK_PRIORITY, NULL) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "Subscribed to %s:%d", CONFIG_RELAY_GROUP, CONFIG_RELAY_PORT);
+  return ESP_OK;
+}
+#endif // CONFIG_ROLE_SUBSCRIBER
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "deploy_state.h"
+#include "esp_err.h"
+#include "poll_scheduler.h"
+#include "sdkconfig.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Snapshot datagram: header followed by one deploy_state_t byte per
+// environment, in the order of the target table (relay and subscribers share
+// the firmware config)
+#define RELAY_MAGIC 0x32535344 // "DSS2" little-endian
+
+// Relay resends its latest snapshot this often, for late joiners and lost
+// datagrams; subscribers give up on a silent relay after RELAY_STALE_MS
+#define RELAY_REPEAT_MS 2000
+#define RELAY_STALE_MS 10000
+#define RELAY_TASK_STACK_SIZE 4096
+#define RELAY_TASK_PRIORITY 4
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint16_t seq;
+  uint8_t count;
+  uint8_t reserved;
+  uint8_t states[POLL_MAX_ENVIRONMENTS];
+} relay_snapshot_t;
+
+#define RELAY_SNAPSHOT_SIZE(count)                                             \
+  (offsetof(relay_snapshot_t, states) + (count))
+
+/**
+ * @brief Open the multicast socket and start the repeat task (relay role)
+ */
+esp_err_t relay_publisher_start(void);
+
+/**
+ * @brief Multicast the current states now, and keep repeating them
+ *
+ * @param states One state per environment
+ * @param count Number of environments
+ */
+void relay_publish(const deploy_state_t *states, int count);
+
+/**
+ * @brief Join the multicast group and start listening (subscriber role)
+ *
+ * Changed states are posted with fetch_pool_post(); when the relay goes
+ * silent for RELAY_STALE_MS every environment is posted as unknown.
+ *
+ * @param count Number of environments; snapshots of another size are dropped
+ */
+esp_err_t relay_subscriber_start(int count);
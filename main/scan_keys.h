@@ -0,0 +1,39 @@
+#pragma once
+
+#include "json_scanner.h"
+
+// Keys and depths the status managers scan provider responses with, shared
+// with the host scanner test so its corpus runs against these exact tables
+
+// GitHub REST: both endpoints return an array of objects, newest first:
+// [{"id":...}]
+#define GH_REST_FIELD_DEPTH 2
+static const json_scan_key_t gh_rest_id_key = {"id", GH_REST_FIELD_DEPTH};
+static const json_scan_key_t gh_rest_state_key = {"state",
+                                                  GH_REST_FIELD_DEPTH};
+
+// GitHub GraphQL: {"data":{"<name>":{"deployments":{"nodes":[{"databaseId":1,
+// "latestStatus":{"state":"SUCCESS"}}]}},...}}
+// Keys 0..N-1 are the target aliases at depth 2, key N is the state and
+// N + 1 the deployment ID. Expand GH_GRAPHQL_KEYS with X defined as
+// GH_GRAPHQL_ALIAS_KEY.
+#define GH_GRAPHQL_ALIAS_KEY(name, owner, repo, env) {#name, 2},
+#define GH_GRAPHQL_KEYS GITHUB_TARGETS{"state", 7}, {"databaseId", 6}
+
+// Vercel: {"deployments":[{"uid":"dpl_...",..."state":"READY",...}],...}
+enum { VERCEL_KEY_DEPLOYMENTS, VERCEL_KEY_STATE, VERCEL_KEY_UID };
+static const json_scan_key_t vercel_target_keys[] = {
+    [VERCEL_KEY_DEPLOYMENTS] = {"deployments", 1},
+    [VERCEL_KEY_STATE] = {"state", 3},
+    [VERCEL_KEY_UID] = {"uid", 3},
+};
+
+// Vercel batch: each deployment object sits at depth 3, and the end of one
+// is reported as an element
+#define VERCEL_BATCH_ELEMENT_DEPTH 3
+enum { VERCEL_KEY_TARGET, VERCEL_KEY_BATCH_STATE, VERCEL_KEY_BATCH_UID };
+static const json_scan_key_t vercel_batch_keys[] = {
+    [VERCEL_KEY_TARGET] = {"target", 3},
+    [VERCEL_KEY_BATCH_STATE] = {"state", 3},
+    [VERCEL_KEY_BATCH_UID] = {"uid", 3},
+};
@@ -0,0 +1,130 @@
+#include "status_store.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "string.h"
+#include "utils.h"
+#include <stdio.h>
+
+static const char *TAG = "STATUS_STORE";
+
+// As stored in flash; deploy_state_t and time_t sizes are not part of it
+typedef struct __attribute__((packed)) {
+  uint8_t version;
+  uint8_t state;
+  int64_t seen;
+  char deployment_id[DEPLOY_ID_LEN];
+} stored_record_t;
+
+static nvs_handle_t handle;
+static bool opened = false;
+// What flash holds per environment, so unchanged saves skip the write
+static status_record_t saved[POLL_MAX_ENVIRONMENTS];
+static bool saved_valid[POLL_MAX_ENVIRONMENTS];
+
+// NVS keys hold 15 characters; names are hashed rather than cut, which would
+// make "marketing-site-prod" and "marketing-site-preview" share a record
+static void make_key(const char *environment, char *key) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  while (*environment) {
+    hash ^= (uint8_t)*environment++;
+    hash *= 16777619u;
+  }
+  snprintf(key, NVS_KEY_NAME_MAX_SIZE, "env_%08lx", (unsigned long)hash);
+}
+
+static bool open_store(void) {
+  if (!opened) {
+    esp_err_t err = nvs_open(STATUS_STORE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+      return false;
+    }
+    opened = true;
+  }
+  return true;
+}
+
+esp_err_t status_store_init(void) {
+  // wifi_manager_init() initializes NVS again, erasing a full or outdated
+  // partition; until then a failure here only means nothing is shown at boot
+  esp_err_t err = nvs_flash_init();
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "NVS not ready: %s", esp_err_to_name(err));
+    return err;
+  }
+  return open_store() ? ESP_OK : ESP_FAIL;
+}
+
+bool status_store_load(int env, const char *environment,
+                       status_record_t *record) {
+  if (env < 0 || env >= POLL_MAX_ENVIRONMENTS || !open_store()) {
+    return false;
+  }
+
+  char key[NVS_KEY_NAME_MAX_SIZE];
+  make_key(environment, key);
+  stored_record_t stored;
+  size_t size = sizeof(stored);
+  if (nvs_get_blob(handle, key, &stored, &size) != ESP_OK ||
+      size != sizeof(stored) || stored.version != STATUS_STORE_VERSION ||
+      stored.state >= DEPLOY_STATE_COUNT) {
+    return false;
+  }
+
+  record->state = (deploy_state_t)stored.state;
+  record->seen = (time_t)stored.seen;
+  memcpy(record->deployment_id, stored.deployment_id, DEPLOY_ID_LEN);
+  record->deployment_id[DEPLOY_ID_LEN - 1] = '\0';
+  saved[env] = *record;
+  saved_valid[env] = true;
+  return true;
+}
+
+esp_err_t status_store_save(int env, const char *environment,
+                            deploy_state_t state, const char *deployment_id) {
+  if (env < 0 || env >= POLL_MAX_ENVIRONMENTS || state >= DEPLOY_STATE_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!deployment_id) {
+    deployment_id = "";
+  }
+
+  status_record_t *record = &saved[env];
+  if (saved_valid[env] && record->state == state &&
+      (!deployment_id[0] ||
+       strncmp(record->deployment_id, deployment_id, DEPLOY_ID_LEN - 1) ==
+           0)) {
+    return ESP_OK;
+  }
+  if (!open_store()) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  stored_record_t stored = {
+      .version = STATUS_STORE_VERSION,
+      .state = (uint8_t)state,
+      .seen = (int64_t)get_real_time(),
+  };
+  strlcpy(stored.deployment_id, deployment_id, sizeof(stored.deployment_id));
+
+  char key[NVS_KEY_NAME_MAX_SIZE];
+  make_key(environment, key);
+  esp_err_t err = nvs_set_blob(handle, key, &stored, sizeof(stored));
+  if (err == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to save %s: %s", environment, esp_err_to_name(err));
+    return err;
+  }
+
+  record->state = state;
+  record->seen = (time_t)stored.seen;
+  strlcpy(record->deployment_id, deployment_id, sizeof(record->deployment_id));
+  saved_valid[env] = true;
+  ESP_LOGI(TAG, "Saved %s: %s %s", environment, deploy_state_label(state),
+           deployment_id);
+  return ESP_OK;
+}
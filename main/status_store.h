@@ -0,0 +1,48 @@
+#pragma once
+
+#include "deploy_state.h"
+#include "esp_err.h"
+#include "poll_scheduler.h"
+#include <stdbool.h>
+#include <time.h>
+
+// Last-known status per environment in NVS, one blob per environment keyed by
+// a hash of its name
+#define STATUS_STORE_NAMESPACE "status_store"
+// Bump when the record layout or the order of DEPLOY_STATES changes, so old
+// records are ignored instead of misread
+#define STATUS_STORE_VERSION 2
+
+typedef struct {
+  deploy_state_t state;
+  time_t seen; // when this state or deployment was first seen, 0 if unknown
+  char deployment_id[DEPLOY_ID_LEN];
+} status_record_t;
+
+/**
+ * @brief Open the store, initializing the NVS partition if wifi_manager_init()
+ * has not yet
+ */
+esp_err_t status_store_init(void);
+
+/**
+ * @brief Read an environment's saved status
+ *
+ * @param env Environment index, below POLL_MAX_ENVIRONMENTS
+ * @param environment Environment name, the record's key
+ * @return true if a record of this firmware's version was found
+ */
+bool status_store_load(int env, const char *environment,
+                       status_record_t *record);
+
+/**
+ * @brief Save an environment's status if it differs from the saved one
+ *
+ * Only a new state or deployment ID is written, to spare the flash. An empty
+ * deployment ID means the source did not say, and alone is not a change.
+ *
+ * @param env Environment index, below POLL_MAX_ENVIRONMENTS
+ * @param environment Environment name, the record's key
+ */
+esp_err_t status_store_save(int env, const char *environment,
+                            deploy_state_t state, const char *deployment_id);
@@ -95,22 +95,58 @@ esp_err_t get_human_real_time(char *timestamp) {
     return ESP_FAIL;
   }
 
+  return format_human_time(now, timestamp);
+}
+
+static esp_err_t to_local_time(time_t unix_time, char *timestamp,
+                               struct tm *timeinfo) {
+  if (timestamp == NULL) {
+    ESP_LOGE(TAG, "Timestamp buffer is NULL");
+    return ESP_ERR_INVALID_ARG;
+  }
+
   // adjust to local time
-  now += CONFIG_TZ_OFFSET * 3600;
+  time_t now = unix_time + CONFIG_TZ_OFFSET * 3600;
 
-  struct tm timeinfo;
-  if (localtime_r(&now, &timeinfo) == NULL) {
+  if (localtime_r(&now, timeinfo) == NULL) {
     ESP_LOGE(TAG, "Failed to convert time to local time");
     return ESP_FAIL;
   }
 
-  // Format as 12-hour HH:MM:SS
-  int hour_12 = timeinfo.tm_hour % 12;
-  if (hour_12 == 0)
-    hour_12 = 12; // Convert 0 to 12 for 12-hour format
+  // 12-hour clock
+  timeinfo->tm_hour %= 12;
+  if (timeinfo->tm_hour == 0)
+    timeinfo->tm_hour = 12; // Convert 0 to 12 for 12-hour format
+  return ESP_OK;
+}
 
-  snprintf(timestamp, 16, "%02d:%02d:%02d", hour_12, timeinfo.tm_min,
+esp_err_t format_human_time(time_t unix_time, char *timestamp) {
+  struct tm timeinfo;
+  esp_err_t err = to_local_time(unix_time, timestamp, &timeinfo);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  // Format as 12-hour HH:MM:SS
+  snprintf(timestamp, 16, "%02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min,
            timeinfo.tm_sec);
 
   return ESP_OK;
 }
+
+esp_err_t format_human_date_time(time_t unix_time, char *timestamp) {
+  static const char *const months[] = {"Jan", "Feb", "Mar", "Apr",
+                                       "May", "Jun", "Jul", "Aug",
+                                       "Sep", "Oct", "Nov", "Dec"};
+  struct tm timeinfo;
+  esp_err_t err = to_local_time(unix_time, timestamp, &timeinfo);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  // Format as Mon DD HH:MM, 12-hour
+  snprintf(timestamp, 13, "%s %02d %02d:%02d", months[timeinfo.tm_mon],
+           timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min);
+
+  return ESP_OK;
+}
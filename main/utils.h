@@ -39,6 +39,26 @@ bool utils_is_time_synchronized(void);
  */
 esp_err_t get_human_real_time(char *timestamp);
 
+/**
+ * @brief Format a Unix timestamp as local time, like get_human_real_time()
+ *
+ * @param unix_time Unix timestamp
+ * @param timestamp Buffer to store the formatted time string (must be at least
+ * 9 bytes)
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+esp_err_t format_human_time(time_t unix_time, char *timestamp);
+
+/**
+ * @brief Format a Unix timestamp as local date and time (Mon DD HH:MM)
+ *
+ * @param unix_time Unix timestamp
+ * @param timestamp Buffer to store the formatted string (must be at least
+ * 13 bytes)
+ * @return esp_err_t ESP_OK on success, error code otherwise
+ */
+esp_err_t format_human_date_time(time_t unix_time, char *timestamp);
+
 #ifdef __cplusplus
 }
 #endif
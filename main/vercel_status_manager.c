@@ -1,22 +1,44 @@
 #include "vercel_status_manager.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "http_conn_manager.h"
+#include "json_scanner.h"
+#include "scan_keys.h"
 #include "string.h"
+#include <stdbool.h>
 #include <stdio.h>
 
 static const char *TAG = "VERCEL_STATUS";
 
-// Static buffers to avoid dynamic allocation
-static char vercel_response_buffer[MAX_VERCEL_RESPONSE_SIZE];
+#define VERCEL_TARGET_COUNT                                                    \
+  ((int)(sizeof(vercel_targets) / sizeof(vercel_targets[0])) - 1)
 
-// Helper function to get pre-built URL for environment
-static const char *get_vercel_deployments_url(const char *environment) {
-  for (int i = 0; vercel_environment_urls[i].name != NULL; i++) {
-    if (strcmp(environment, vercel_environment_urls[i].name) == 0) {
-      return vercel_environment_urls[i].url;
+// Vercel's ERROR has always been shown as a failed deployment
+static deploy_state_t vercel_parse_state(const char *raw_status) {
+  deploy_state_t state = deploy_state_parse(raw_status);
+  return state == DEPLOY_STATE_ERROR ? DEPLOY_STATE_FAILURE : state;
+}
+
+static int get_vercel_target_index(const char *name) {
+  for (int i = 0; vercel_targets[i].name != NULL; i++) {
+    if (strcmp(name, vercel_targets[i].name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int vercel_find_target(const char *project, const char *target) {
+  for (int i = 0; vercel_targets[i].name != NULL; i++) {
+    if (strcmp(project, vercel_targets[i].project) == 0 &&
+        strcmp(target, vercel_targets[i].target) == 0) {
+      return i;
     }
   }
-  return NULL; // Unknown environment
+  return -1;
 }
 
 static esp_err_t vercel_http_event_handler(esp_http_client_event_t *evt) {
@@ -32,21 +54,6 @@ static esp_err_t vercel_http_event_handler(esp_http_client_event_t *evt) {
     break;
   case HTTP_EVENT_ON_HEADER:
     break;
-  case HTTP_EVENT_ON_DATA:
-    if (!esp_http_client_is_chunked_response(evt->client)) {
-      size_t data_len = evt->data_len;
-      size_t buffer_len = strlen(vercel_response_buffer);
-
-      // Prevent buffer overflow
-      if (buffer_len + data_len >= MAX_VERCEL_RESPONSE_SIZE) {
-        data_len = MAX_VERCEL_RESPONSE_SIZE - buffer_len - 1;
-      }
-
-      if (data_len > 0) {
-        strncat(vercel_response_buffer, evt->data, data_len);
-      }
-    }
-    break;
   case HTTP_EVENT_ON_FINISH:
     ESP_LOGI(TAG, "HTTP request finished");
     break;
@@ -59,186 +66,266 @@ static esp_err_t vercel_http_event_handler(esp_http_client_event_t *evt) {
   return ESP_OK;
 }
 
-static esp_err_t parse_vercel_json_field(const char *json,
-                                         const char *field_name, char *value,
-                                         size_t value_size) {
-  if (!json || !field_name || !value || value_size == 0) {
-    return ESP_ERR_INVALID_ARG;
-  }
 
-  char search_pattern[64];
-  snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", field_name);
+// The scanner hands over at most JSON_SCAN_TOKEN_SIZE - 1 characters
+_Static_assert(JSON_SCAN_TOKEN_SIZE > DEPLOY_ID_MAX_CHARS,
+               "scanner tokens must hold a whole uid");
 
-  const char *field_start = strstr(json, search_pattern);
-  if (!field_start) {
-    return ESP_ERR_NOT_FOUND;
+typedef struct {
+  bool deployments_seen;
+  bool found;
+  char raw_status[32];
+  char uid[DEPLOY_ID_LEN];
+} target_result_t;
+
+static bool target_scan_cb(void *ctx, int key_index, const char *value) {
+  target_result_t *result = (target_result_t *)ctx;
+  if (key_index == VERCEL_KEY_DEPLOYMENTS) {
+    result->deployments_seen = true;
+    return true;
   }
-
-  const char *value_start = strchr(field_start, ':');
-  if (!value_start) {
-    return ESP_ERR_NOT_FOUND;
+  if (key_index == VERCEL_KEY_STATE && value) {
+    strlcpy(result->raw_status, value, sizeof(result->raw_status));
+    result->found = true;
+  } else if (key_index == VERCEL_KEY_UID && value) {
+    strlcpy(result->uid, value, sizeof(result->uid));
   }
+  // First (and only) deployment read, stop scanning
+  return !result->found || !result->uid[0];
+}
+
+// Fetch the latest deployment of a single target
+static esp_err_t fetch_target_status(int index, deploy_state_t *state,
+                                     char *deployment_id) {
+  // Pre-built URL for the target
+  const char *url = vercel_targets[index].url;
+
+  target_result_t result = {0};
+  json_scanner_t scanner;
+  json_scanner_init(&scanner, vercel_target_keys,
+                    sizeof(vercel_target_keys) / sizeof(vercel_target_keys[0]),
+                    0,
+                    target_scan_cb, &result);
+
+  http_conn_request_t request = {
+      .url = url,
+      .scanner = &scanner,
+      .event_handler = vercel_http_event_handler,
+  };
 
-  value_start++; // Skip ':'
-  while (*value_start == ' ' || *value_start == '\t') {
-    value_start++; // Skip whitespace
+  int status_code = 0;
+  esp_err_t err = http_conn_perform(HTTP_HOST_VERCEL, &request, &status_code);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Vercel HTTP request failed: %s", esp_err_to_name(err));
+    *state = DEPLOY_STATE_UNKNOWN;
+    return err;
   }
+  ESP_LOGI(TAG, "HTTP Status: %d", status_code);
 
-  const char *value_end;
-  if (*value_start == '"') {
-    // String value
-    value_start++; // Skip opening quote
-    value_end = strchr(value_start, '"');
-    if (!value_end) {
-      return ESP_ERR_INVALID_RESPONSE;
-    }
-  } else {
-    // Numeric value
-    value_end = value_start;
-    while ((*value_end >= '0' && *value_end <= '9') || *value_end == '.') {
-      value_end++;
-    }
-    // Don't include trailing comma, bracket, or whitespace in the value
+  if (status_code != 200) {
+    ESP_LOGE(TAG, "Vercel HTTP request failed with status %d", status_code);
+    *state = DEPLOY_STATE_UNKNOWN;
+    return ESP_FAIL;
   }
 
-  size_t value_len = value_end - value_start;
-  if (value_len >= value_size) {
-    value_len = value_size - 1;
+  if (result.found) {
+    *state = vercel_parse_state(result.raw_status);
+    strlcpy(deployment_id, result.uid, DEPLOY_ID_LEN);
+    ESP_LOGI(TAG, "Found deployment with state: %s", result.raw_status);
+    return ESP_OK;
   }
 
-  strncpy(value, value_start, value_len);
-  value[value_len] = '\0';
+  if (result.deployments_seen && scanner.status != JSON_SCAN_ERROR) {
+    ESP_LOGW(TAG, "No deployments found for this environment");
+    *state = DEPLOY_STATE_NONE;
+    return ESP_OK;
+  }
 
-  return ESP_OK;
+  ESP_LOGE(TAG, "Failed to parse Vercel deployment status");
+  *state = DEPLOY_STATE_UNKNOWN;
+  return ESP_ERR_INVALID_RESPONSE;
 }
 
-static esp_err_t parse_vercel_deployment_status(const char *json, char *status,
-                                                size_t status_size) {
-  if (!json || !status || status_size == 0) {
-    return ESP_ERR_INVALID_ARG;
+#ifdef CONFIG_VERCEL_BATCH_FETCH
+// Newest state per target from the last batch request of its project, or
+// that request's error; each entry is handed out once, and the next lookup of
+// a consumed or aged-out target triggers a new batch for that project
+static struct {
+  deploy_state_t state;
+  char deployment_id[DEPLOY_ID_LEN];
+  esp_err_t err;
+  bool fresh;
+  bool seen;
+  int64_t fetched_ms;
+} vercel_batch_results[VERCEL_TARGET_COUNT];
+// Held across the freshness check and refetch so that workers polling
+// different targets share one batch request
+static SemaphoreHandle_t vercel_batch_lock;
+
+typedef struct {
+  const char *project;
+  char target[32];
+  char raw_status[32];
+  char uid[DEPLOY_ID_LEN];
+  int remaining; // watched targets of the project not seen yet
+} batch_ctx_t;
+
+// Walk the deployments array once (newest first) and record the first state
+// seen for each watched target of the project
+static bool batch_scan_cb(void *ctx, int key_index, const char *value) {
+  batch_ctx_t *batch = (batch_ctx_t *)ctx;
+
+  switch (key_index) {
+  case VERCEL_KEY_TARGET:
+    strlcpy(batch->target, value ? value : "", sizeof(batch->target));
+    return true;
+  case VERCEL_KEY_BATCH_STATE:
+    strlcpy(batch->raw_status, value ? value : "", sizeof(batch->raw_status));
+    return true;
+  case VERCEL_KEY_BATCH_UID:
+    strlcpy(batch->uid, value ? value : "", sizeof(batch->uid));
+    return true;
+  default:
+    break;
   }
 
-  // Vercel API returns: {"deployments": [...]}
-  // Look for the "deployments" key
-  const char *deployments_key = strstr(json, "\"deployments\"");
-  if (!deployments_key) {
-    ESP_LOGE(TAG, "No 'deployments' key found in Vercel response");
-    return ESP_ERR_INVALID_RESPONSE;
+  // End of one deployment object; "target":null (preview) matches nothing
+  int index = vercel_find_target(batch->project, batch->target);
+  if (index >= 0 && batch->raw_status[0] &&
+      !vercel_batch_results[index].seen) {
+    vercel_batch_results[index].state = vercel_parse_state(batch->raw_status);
+    strlcpy(vercel_batch_results[index].deployment_id, batch->uid,
+            sizeof(vercel_batch_results[index].deployment_id));
+    vercel_batch_results[index].seen = true;
+    batch->remaining--;
+    ESP_LOGI(TAG, "Batch %s: %s", vercel_targets[index].name,
+             batch->raw_status);
   }
+  batch->target[0] = '\0';
+  batch->raw_status[0] = '\0';
+  batch->uid[0] = '\0';
+  return batch->remaining > 0;
+}
 
-  // Find the array after "deployments":
-  const char *array_start = strstr(deployments_key, "[");
-  if (!array_start) {
-    ESP_LOGE(TAG, "No deployments array found in Vercel response");
-    return ESP_ERR_INVALID_RESPONSE;
+static void batch_fetch_project(const char *project) {
+  batch_ctx_t batch = {.project = project};
+  int64_t now_ms = esp_timer_get_time() / 1000;
+  for (int i = 0; i < VERCEL_TARGET_COUNT; i++) {
+    if (strcmp(vercel_targets[i].project, project) == 0) {
+      vercel_batch_results[i].seen = false;
+      vercel_batch_results[i].err = ESP_OK;
+      vercel_batch_results[i].fresh = true;
+      vercel_batch_results[i].fetched_ms = now_ms;
+      batch.remaining++;
+    }
   }
 
-  // Check if array is empty (just "[]")
-  const char *array_end = strstr(array_start, "]");
-  if (!array_end || array_end - array_start <= 2) {
-    ESP_LOGW(TAG, "No deployments found for this environment");
-    strncpy(status, "NO DEPLOYMENTS", status_size - 1);
-    status[status_size - 1] = '\0';
-    return ESP_OK;
-  }
+  char url[MAX_VERCEL_URL_SIZE];
+  snprintf(url, sizeof(url), VERCEL_BATCH_URL_FMT, project);
 
-  // Get the first (and only) deployment object
-  const char *object_start = strstr(array_start, "{");
-  if (!object_start) {
-    ESP_LOGE(TAG, "No deployment object found in response");
-    return ESP_ERR_INVALID_RESPONSE;
-  }
+  json_scanner_t scanner;
+  json_scanner_init(&scanner, vercel_batch_keys,
+                    sizeof(vercel_batch_keys) / sizeof(vercel_batch_keys[0]),
+                    VERCEL_BATCH_ELEMENT_DEPTH, batch_scan_cb, &batch);
 
-  char raw_status[32];
-  esp_err_t err = parse_vercel_json_field(object_start, "state", raw_status,
-                                          sizeof(raw_status));
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to parse deployment state");
-    return err;
-  }
+  http_conn_request_t request = {
+      .url = url,
+      .scanner = &scanner,
+      .event_handler = vercel_http_event_handler,
+  };
 
-  // Map Vercel states to display-friendly strings
-  if (strcmp(raw_status, "READY") == 0) {
-    strncpy(status, "SUCCESS", status_size - 1);
-    status[status_size - 1] = '\0';
-  } else if (strcmp(raw_status, "BUILDING") == 0) {
-    strncpy(status, "IN PROGRESS", status_size - 1);
-    status[status_size - 1] = '\0';
-  } else if (strcmp(raw_status, "ERROR") == 0) {
-    strncpy(status, "FAILURE", status_size - 1);
-    status[status_size - 1] = '\0';
-  } else if (strcmp(raw_status, "CANCELED") == 0) {
-    strncpy(status, "CANCELED", status_size - 1);
-    status[status_size - 1] = '\0';
+  int status_code = 0;
+  esp_err_t err = http_conn_perform(HTTP_HOST_VERCEL, &request, &status_code);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Vercel batch request failed: %s", esp_err_to_name(err));
   } else {
-    strncpy(status, raw_status, status_size - 1);
-    status[status_size - 1] = '\0';
+    ESP_LOGI(TAG, "Batch HTTP Status: %d", status_code);
+    if (status_code != 200) {
+      ESP_LOGE(TAG, "Vercel batch request failed with status %d",
+               status_code);
+      err = ESP_FAIL;
+    }
+  }
+  if (err == ESP_OK) {
+    return;
   }
 
-  ESP_LOGI(TAG, "Found deployment with state: %s -> %s", raw_status, status);
-  return ESP_OK;
+  // Every target of the project gets the error for this cycle rather than a
+  // request of its own, which a 403/429 would only make worse
+  for (int i = 0; i < VERCEL_TARGET_COUNT; i++) {
+    if (strcmp(vercel_targets[i].project, project) == 0) {
+      vercel_batch_results[i].err = err;
+    }
+  }
 }
 
-esp_err_t vercel_check_deployment_status(const char *environment, char *status,
-                                         size_t status_size) {
-  if (!environment || !status || status_size == 0) {
+esp_err_t vercel_check_deployment_status(const char *environment,
+                                         deploy_state_t *state,
+                                         char *deployment_id) {
+  if (!environment || !state || !deployment_id) {
     return ESP_ERR_INVALID_ARG;
   }
 
-  // Clear response buffer
-  memset(vercel_response_buffer, 0, sizeof(vercel_response_buffer));
-
-  // Get pre-built URL for environment
-  const char *url = get_vercel_deployments_url(environment);
-  if (!url) {
-    ESP_LOGE(TAG, "Unknown environment: %s", environment);
+  deployment_id[0] = '\0';
+  int index = get_vercel_target_index(environment);
+  if (index < 0) {
+    ESP_LOGE(TAG, "Unknown target: %s", environment);
     return ESP_ERR_INVALID_ARG;
   }
 
-  esp_http_client_config_t config = {
-      .url = url,
-      .method = HTTP_METHOD_GET,
-      .event_handler = vercel_http_event_handler,
-      .buffer_size = MAX_VERCEL_RESPONSE_SIZE,
-      .buffer_size_tx = MAX_VERCEL_RESPONSE_SIZE,
-  };
+  xSemaphoreTake(vercel_batch_lock, portMAX_DELAY);
+  int64_t age_ms =
+      esp_timer_get_time() / 1000 - vercel_batch_results[index].fetched_ms;
+  if (!vercel_batch_results[index].fresh ||
+      age_ms > VERCEL_BATCH_RESULT_MAX_AGE_MS) {
+    batch_fetch_project(vercel_targets[index].project);
+  }
+  vercel_batch_results[index].fresh = false;
+  bool seen = vercel_batch_results[index].seen;
+  esp_err_t batch_err = vercel_batch_results[index].err;
+  if (seen) {
+    *state = vercel_batch_results[index].state;
+    strlcpy(deployment_id, vercel_batch_results[index].deployment_id,
+            DEPLOY_ID_LEN);
+  }
+  xSemaphoreGive(vercel_batch_lock);
 
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  if (!client) {
-    ESP_LOGE(TAG, "Failed to initialize HTTP client");
-    return ESP_ERR_NO_MEM;
+  if (seen) {
+    return ESP_OK;
+  }
+  if (batch_err != ESP_OK) {
+    *state = DEPLOY_STATE_UNKNOWN;
+    return batch_err;
   }
 
-  // Set Vercel token header
-  esp_http_client_set_header(client, "Authorization",
-                             "Bearer " CONFIG_VERCEL_AUTH_TOKEN);
-  esp_http_client_set_header(client, "User-Agent", "ESP32-Vercel-Status");
-  esp_http_client_set_header(client, "Accept", "application/json");
+  // Not among the latest deployments: ask per target
+  ESP_LOGI(TAG, "%s not in batch, falling back to per-target request",
+           environment);
+  return fetch_target_status(index, state, deployment_id);
+}
 
-  esp_err_t err = esp_http_client_perform(client);
-  if (err == ESP_OK) {
-    int status_code = esp_http_client_get_status_code(client);
-    ESP_LOGI(TAG, "HTTP Status: %d", status_code);
-
-    if (status_code == 200) {
-      err = parse_vercel_deployment_status(vercel_response_buffer, status,
-                                           status_size);
-      if (err == ESP_OK) {
-        ESP_LOGI(TAG, "Found Vercel deployment status: %s", status);
-      } else {
-        ESP_LOGE(TAG, "Failed to parse Vercel deployment status");
-        snprintf(status, status_size, "unknown");
-      }
-    } else {
-      ESP_LOGE(TAG, "Vercel HTTP request failed with status %d", status_code);
-      snprintf(status, status_size, "unknown");
-      err = ESP_FAIL;
-    }
-  } else {
-    ESP_LOGE(TAG, "Vercel HTTP request failed: %s", esp_err_to_name(err));
-    snprintf(status, status_size, "unknown");
+esp_err_t vercel_status_manager_init(void) {
+  vercel_batch_lock = xSemaphoreCreateMutex();
+  return vercel_batch_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+#else
+esp_err_t vercel_check_deployment_status(const char *environment,
+                                         deploy_state_t *state,
+                                         char *deployment_id) {
+  if (!environment || !state || !deployment_id) {
+    return ESP_ERR_INVALID_ARG;
   }
 
-  esp_http_client_cleanup(client);
-  return err;
+  deployment_id[0] = '\0';
+  int index = get_vercel_target_index(environment);
+  if (index < 0) {
+    ESP_LOGE(TAG, "Unknown target: %s", environment);
+    return ESP_ERR_INVALID_ARG;
+  }
+  return fetch_target_status(index, state, deployment_id);
+}
+
+esp_err_t vercel_status_manager_init(void) {
+  return ESP_OK; // per-target requests share no state
 }
+#endif // CONFIG_VERCEL_BATCH_FETCH
@@ -1,32 +1,64 @@
 #pragma once
 
+#include "deploy_state.h"
 #include "esp_err.h"
 #include "sdkconfig.h"
+#include <stddef.h>
 
 // Vercel API endpoint
 #define VERCEL_DEPLOYMENTS_BASE "https://api.vercel.com/v6/deployments"
 
-// Pre-built URLs for each environment
-#define VERCEL_ENVIRONMENTS                                                    \
-  X(production)                                                                \
-  X(staging)
+// Monitored targets: X(name, project_id, target). name is the panel label and
+// must be unique; add rows to watch targets of other projects in the team.
+#define VERCEL_TARGETS                                                         \
+  X(production, CONFIG_VERCEL_PROJECT_ID, "production")                        \
+  X(staging, CONFIG_VERCEL_PROJECT_ID, "staging")
 
-// Generate environment URL lookup table at build time
-#define X(env)                                                                 \
-  {#env, VERCEL_DEPLOYMENTS_BASE "?projectId=" CONFIG_VERCEL_PROJECT_ID        \
-                                 "&teamId=" CONFIG_VERCEL_TEAM_ID              \
-                                 "&target=" #env "&limit=1"},
+// Generate target lookup table at build time
+#define X(name, project, target)                                               \
+  {#name, project, target,                                                     \
+   VERCEL_DEPLOYMENTS_BASE "?projectId=" project                               \
+                           "&teamId=" CONFIG_VERCEL_TEAM_ID                    \
+                           "&target=" target "&limit=1"},
 static const struct {
   const char *name;
-  const char *url;
-} vercel_environment_urls[] = {
-    VERCEL_ENVIRONMENTS{NULL, NULL} // Sentinel
+  const char *project;
+  const char *target;
+  const char *url; // latest deployment of this target
+} vercel_targets[] = {
+    VERCEL_TARGETS{NULL, NULL, NULL, NULL} // Sentinel
 };
 #undef X
 
-// Response buffer size (sufficient for single deployment response)
-#define MAX_VERCEL_RESPONSE_SIZE 2048
+// Batch mode: latest deployments of one project across all its targets
+#define VERCEL_STRINGIFY_(x) #x
+#define VERCEL_STRINGIFY(x) VERCEL_STRINGIFY_(x)
+#define VERCEL_BATCH_URL_FMT                                                   \
+  VERCEL_DEPLOYMENTS_BASE "?projectId=%s&teamId=" CONFIG_VERCEL_TEAM_ID        \
+                          "&limit=" VERCEL_STRINGIFY(CONFIG_VERCEL_BATCH_LIMIT)
+#define MAX_VERCEL_URL_SIZE 256
+
+// Batch results older than this are refetched rather than handed out, since
+// targets are polled on independent schedules
+#define VERCEL_BATCH_RESULT_MAX_AGE_MS 5000
 
 // Function declarations
-esp_err_t vercel_check_deployment_status(const char *environment, char *status,
-                                         size_t status_size);
+esp_err_t vercel_status_manager_init(void);
+
+/**
+ * @brief Look up the latest deployment of a target and its state
+ *
+ * @param environment Target name from VERCEL_TARGETS
+ * @param state Latest deployment's state
+ * @param deployment_id DEPLOY_ID_LEN buffer for its uid, empty if unknown
+ */
+esp_err_t vercel_check_deployment_status(const char *environment,
+                                         deploy_state_t *state,
+                                         char *deployment_id);
+
+/**
+ * @brief Find the entry watching a target of a project
+ *
+ * @return int Index into VERCEL_TARGETS, -1 if not watched
+ */
+int vercel_find_target(const char *project, const char *target);
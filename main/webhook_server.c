@@ -0,0 +1,325 @@
+#include "webhook_server.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "fetch_pool.h"
+#include "gh_status_manager.h"
+#include "json_scanner.h"
+#include "mbedtls/md.h"
+#include "string.h"
+#include "vercel_status_manager.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <strings.h>
+
+#ifdef CONFIG_WEBHOOK_ENABLE
+static const char *TAG = "WEBHOOK";
+
+#ifdef CONFIG_USE_VERCEL
+// {"type":"deployment.succeeded","payload":{"deployment":{"id":...},
+// "target":"production","project":{"id":"prj_..."},...}}
+#define SIGNATURE_HEADER "x-vercel-signature"
+#define SIGNATURE_PREFIX ""
+#define SIGNATURE_MD MBEDTLS_MD_SHA1
+enum { KEY_EVENT, KEY_ENVIRONMENT, KEY_PROJECT, KEY_ID };
+static const json_scan_key_t webhook_keys[] = {
+    [KEY_EVENT] = {"type", 1},
+    [KEY_ENVIRONMENT] = {"target", 2},
+    [KEY_PROJECT] = {"project", 2},
+    [KEY_ID] = {"id", 3},
+};
+// Objects under "payload" end at this depth, which tells project.id apart
+// from the deployment's id
+#define WEBHOOK_ELEMENT_DEPTH 3
+#define find_target vercel_find_target
+#else
+// {"deployment_status":{"state":"success","environment":"production",...},
+// "deployment":{...},"repository":{"full_name":"owner/repo",...},...}
+#define SIGNATURE_HEADER "X-Hub-Signature-256"
+#define SIGNATURE_PREFIX "sha256="
+#define SIGNATURE_MD MBEDTLS_MD_SHA256
+enum {
+  KEY_EVENT,
+  KEY_ENVIRONMENT,
+  KEY_PROJECT,
+  KEY_STATUS_OBJECT,
+  KEY_DEPLOYMENT_OBJECT,
+  KEY_REPOSITORY_OBJECT,
+};
+static const json_scan_key_t webhook_keys[] = {
+    [KEY_EVENT] = {"state", 2},
+    [KEY_ENVIRONMENT] = {"environment", 2},
+    [KEY_PROJECT] = {"full_name", 2},
+    [KEY_STATUS_OBJECT] = {"deployment_status", 1},
+    [KEY_DEPLOYMENT_OBJECT] = {"deployment", 1},
+    [KEY_REPOSITORY_OBJECT] = {"repository", 1},
+};
+// Top-level objects end at this depth, which scopes each field to the object
+// it belongs to; workflow_run and others repeat the same keys
+#define WEBHOOK_ELEMENT_DEPTH 2
+#define find_target gh_find_target
+#endif
+
+typedef struct {
+  char event[32]; // GitHub state or Vercel event type
+  char environment[32];
+  char project[64]; // GitHub owner/repo or Vercel project ID
+#ifdef CONFIG_USE_VERCEL
+  bool in_project; // inside Vercel's payload.project object
+#else
+  int object; // KEY_*_OBJECT being scanned, or -1 outside them
+  char deployment_environment[32]; // if deployment_status has none
+#endif
+} webhook_fields_t;
+
+static void set_once(char *field, size_t size, const char *value) {
+  if (value && !field[0]) {
+    strlcpy(field, value, size);
+  }
+}
+
+// Keep the first occurrence of each key in the object it belongs to
+static bool webhook_scan_cb(void *ctx, int key_index, const char *value) {
+  webhook_fields_t *fields = (webhook_fields_t *)ctx;
+
+  switch (key_index) {
+#ifdef CONFIG_USE_VERCEL
+  case KEY_EVENT:
+    set_once(fields->event, sizeof(fields->event), value);
+    break;
+  case KEY_ENVIRONMENT:
+    set_once(fields->environment, sizeof(fields->environment), value);
+    break;
+  case KEY_PROJECT:
+    fields->in_project = (value == NULL);
+    break;
+  case KEY_ID:
+    if (fields->in_project) {
+      set_once(fields->project, sizeof(fields->project), value);
+    }
+    break;
+  case JSON_SCAN_ELEMENT_END:
+    fields->in_project = false;
+    break;
+#else
+  case KEY_STATUS_OBJECT:
+  case KEY_DEPLOYMENT_OBJECT:
+  case KEY_REPOSITORY_OBJECT:
+    fields->object = value == NULL ? key_index : -1;
+    break;
+  case JSON_SCAN_ELEMENT_END:
+    fields->object = -1;
+    break;
+  case KEY_EVENT:
+    if (fields->object == KEY_STATUS_OBJECT) {
+      set_once(fields->event, sizeof(fields->event), value);
+    }
+    break;
+  case KEY_ENVIRONMENT:
+    if (fields->object == KEY_STATUS_OBJECT) {
+      set_once(fields->environment, sizeof(fields->environment), value);
+    } else if (fields->object == KEY_DEPLOYMENT_OBJECT) {
+      set_once(fields->deployment_environment,
+               sizeof(fields->deployment_environment), value);
+    }
+    break;
+  case KEY_PROJECT:
+    if (fields->object == KEY_REPOSITORY_OBJECT) {
+      set_once(fields->project, sizeof(fields->project), value);
+    }
+    break;
+#endif
+  default:
+    break;
+  }
+  return !fields->event[0] || !fields->environment[0] || !fields->project[0];
+}
+
+// Translate the payload's event into the state the poller would report
+static bool webhook_state(const webhook_fields_t *fields,
+                          deploy_state_t *state) {
+#ifdef CONFIG_USE_VERCEL
+  static const struct {
+    const char *type;
+    deploy_state_t state;
+  } vercel_events[] = {
+      {"deployment.created", DEPLOY_STATE_IN_PROGRESS},
+      {"deployment.succeeded", DEPLOY_STATE_SUCCESS},
+      {"deployment.ready", DEPLOY_STATE_SUCCESS},
+      {"deployment.error", DEPLOY_STATE_FAILURE},
+      {"deployment.canceled", DEPLOY_STATE_CANCELED},
+  };
+  for (size_t i = 0; i < sizeof(vercel_events) / sizeof(vercel_events[0]);
+       i++) {
+    if (strcmp(fields->event, vercel_events[i].type) == 0) {
+      *state = vercel_events[i].state;
+      return true;
+    }
+  }
+  return false;
+#else
+  if (!fields->event[0]) {
+    return false;
+  }
+  *state = deploy_state_parse(fields->event);
+  return true;
+#endif
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c |= 0x20;
+  return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// Compare a hex signature with a digest in constant time
+static bool signature_matches(const char *hex, const unsigned char *digest,
+                              size_t digest_size) {
+  if (strlen(hex) != digest_size * 2) {
+    return false;
+  }
+  unsigned char diff = 0;
+  for (size_t i = 0; i < digest_size; i++) {
+    int hi = hex_value(hex[2 * i]);
+    int lo = hex_value(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0) {
+      return false;
+    }
+    diff |= (unsigned char)((hi << 4) | lo) ^ digest[i];
+  }
+  return diff == 0;
+}
+
+static esp_err_t webhook_post_handler(httpd_req_t *req) {
+#ifndef CONFIG_USE_VERCEL
+  char event_type[32] = "";
+  httpd_req_get_hdr_value_str(req, "X-GitHub-Event", event_type,
+                              sizeof(event_type));
+  if (strcmp(event_type, "deployment_status") != 0) {
+    // ping and anything else the hook is subscribed to
+    ESP_LOGI(TAG, "Ignoring '%s' event", event_type);
+    return httpd_resp_sendstr(req, "ignored");
+  }
+#endif
+
+  char signature[WEBHOOK_SIGNATURE_SIZE] = "";
+  httpd_req_get_hdr_value_str(req, SIGNATURE_HEADER, signature,
+                              sizeof(signature));
+  size_t prefix_len = strlen(SIGNATURE_PREFIX);
+  if (strncasecmp(signature, SIGNATURE_PREFIX, prefix_len) != 0) {
+    ESP_LOGW(TAG, "Missing %s header", SIGNATURE_HEADER);
+    return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "unsigned");
+  }
+
+  // Hash and scan the body as it streams in; nothing is applied until the
+  // signature over the whole body checks out
+  const mbedtls_md_info_t *md_info = mbedtls_md_info_from_type(SIGNATURE_MD);
+  mbedtls_md_context_t md;
+  mbedtls_md_init(&md);
+  if (mbedtls_md_setup(&md, md_info, 1) != 0 ||
+      mbedtls_md_hmac_starts(&md, (const unsigned char *)CONFIG_WEBHOOK_SECRET,
+                             strlen(CONFIG_WEBHOOK_SECRET)) != 0) {
+    mbedtls_md_free(&md);
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+  }
+
+  webhook_fields_t fields = {0};
+#ifndef CONFIG_USE_VERCEL
+  fields.object = -1;
+#endif
+  json_scanner_t scanner;
+  json_scanner_init(&scanner, webhook_keys,
+                    sizeof(webhook_keys) / sizeof(webhook_keys[0]),
+                    WEBHOOK_ELEMENT_DEPTH, webhook_scan_cb, &fields);
+
+  char chunk[WEBHOOK_CHUNK_SIZE];
+  size_t remaining = req->content_len;
+  int timeouts = 0;
+  while (remaining > 0) {
+    int len = httpd_req_recv(req, chunk,
+                             remaining < sizeof(chunk) ? remaining
+                                                       : sizeof(chunk));
+    if (len == HTTPD_SOCK_ERR_TIMEOUT) {
+      // A stalled sender would otherwise hold the server's only task
+      if (++timeouts < WEBHOOK_RECV_TIMEOUTS) {
+        continue;
+      }
+      ESP_LOGW(TAG, "Body stalled with %u bytes left", (unsigned)remaining);
+      mbedtls_md_free(&md);
+      return httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, NULL);
+    }
+    if (len <= 0) {
+      mbedtls_md_free(&md);
+      return ESP_FAIL; // connection gone, nothing to answer
+    }
+    mbedtls_md_hmac_update(&md, (const unsigned char *)chunk, len);
+    json_scanner_feed(&scanner, chunk, len);
+    remaining -= len;
+  }
+
+  unsigned char digest[MBEDTLS_MD_MAX_SIZE];
+  mbedtls_md_hmac_finish(&md, digest);
+  mbedtls_md_free(&md);
+  if (!signature_matches(signature + prefix_len, digest,
+                         mbedtls_md_get_size(md_info))) {
+    ESP_LOGW(TAG, "Signature mismatch, payload dropped");
+    return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "bad signature");
+  }
+
+#ifndef CONFIG_USE_VERCEL
+  if (!fields.environment[0]) {
+    strlcpy(fields.environment, fields.deployment_environment,
+            sizeof(fields.environment));
+  }
+#endif
+
+  fetch_result_t result = {.err = ESP_OK};
+  result.env = find_target(fields.project, fields.environment);
+  if (result.env < 0 ||
+      !webhook_state(&fields, &result.state)) {
+    ESP_LOGI(TAG, "No update for %s '%s' (%s)", fields.project,
+             fields.environment, fields.event);
+    return httpd_resp_sendstr(req, "ignored");
+  }
+
+  ESP_LOGI(TAG, "%s '%s': %s", fields.project, fields.environment,
+           deploy_state_label(result.state));
+  fetch_pool_post(&result);
+  return httpd_resp_sendstr(req, "ok");
+}
+
+esp_err_t webhook_server_start(void) {
+  // An empty key would let anyone sign a payload
+  if (strlen(CONFIG_WEBHOOK_SECRET) == 0) {
+    ESP_LOGE(TAG, "WEBHOOK_SECRET is empty, not starting the server");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = CONFIG_WEBHOOK_PORT;
+  config.stack_size = WEBHOOK_STACK_SIZE;
+
+  httpd_handle_t server = NULL;
+  esp_err_t err = httpd_start(&server, &config);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start server: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  const httpd_uri_t webhook_uri = {
+      .uri = WEBHOOK_URI,
+      .method = HTTP_POST,
+      .handler = webhook_post_handler,
+  };
+  err = httpd_register_uri_handler(server, &webhook_uri);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register handler: %s", esp_err_to_name(err));
+    httpd_stop(server);
+    return err;
+  }
+
+  ESP_LOGI(TAG, "Listening on port %d%s", CONFIG_WEBHOOK_PORT, WEBHOOK_URI);
+  return ESP_OK;
+}
+#endif // CONFIG_WEBHOOK_ENABLE
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#define WEBHOOK_URI "/webhook"
+#define WEBHOOK_STACK_SIZE 6144
+// Request body is read and hashed in chunks of this size
+#define WEBHOOK_CHUNK_SIZE 512
+#define WEBHOOK_SIGNATURE_SIZE 80
+// Receive timeouts allowed per request body before answering 408
+#define WEBHOOK_RECV_TIMEOUTS 3
+
+/**
+ * @brief Start the webhook server on CONFIG_WEBHOOK_PORT
+ *
+ * Accepts the active provider's deployment webhooks on POST /webhook: GitHub
+ * deployment_status events signed with X-Hub-Signature-256, or Vercel
+ * deployment events signed with x-vercel-signature. Verified updates for a
+ * watched target are posted with fetch_pool_post(), with env set to the
+ * target's index in GITHUB_TARGETS or VERCEL_TARGETS.
+ *
+ * @return esp_err_t ESP_OK if the server is running, ESP_ERR_INVALID_STATE
+ * if CONFIG_WEBHOOK_SECRET is empty
+ */
+esp_err_t webhook_server_start(void);